@@ -6,6 +6,6 @@
 
 using AntColonyId = uint8_t;
 using NestId = uint8_t;
-using AntId = uint16_t;
+using AntId = uint32_t;
 
 #endif //ANTS_ALIASES_HPP
@@ -1,7 +1,6 @@
 #include "Ant.hpp"
 
 #include "World.hpp"
-#include "Random.hpp"
 #include "Settings.hpp"
 
 #include <raymath.h>
@@ -10,168 +9,170 @@
 
 constexpr float k_pheromoneSpawnIntensity = 128;
 
-constexpr float k_pheromoneSpawnDelay = 20;
-constexpr float k_fovCheckDelay       = 3;
+// In ticks
+constexpr uint32_t k_pheromoneSpawnDelay = 20;
+constexpr uint32_t k_fovCheckDelay       = 3;
 
 constexpr float k_decreasingPheromonesMultiplier = 1;
 
-Ant::Ant(AntId id, AntColonyId colonyId, const Vector2 &pos) :
-		m_id(id),
-		m_colonyId(colonyId),
-		m_pos(pos), m_prevPos(m_pos),
-		m_state(SearchForFood),
-		m_antsSettings(Settings::Instance().GetAntsSettings())
+void Ant::Init(const Vector2 &pos)
 {
-	m_rotation        = Random::Float(-M_PI, M_PI);
-	m_desiredRotation = m_rotation;
+	SetPos(pos);
+	m_data.prevPosX[m_index] = pos.x;
+	m_data.prevPosY[m_index] = pos.y;
 
-	m_colorsPtr[0] = &m_antsSettings.antDefaultColor;
-	m_colorsPtr[1] = &m_antsSettings.antWithFoodColor;
+	State() = StateType::SearchForFood;
+	m_data.flags[m_index]             = 0;
+	m_data.pheromoneStrength[m_index] = 1;
 
-	m_pheromoneSpawnTimer.SetDelay(k_pheromoneSpawnDelay);
-	m_fovCheckTimer.SetDelay(k_fovCheckDelay);
-	RandomizeDeviationDelay();
-	m_deviationResetTimer.SetDelay(m_antsSettings.deviationTime);
-	m_lostPheromoneTimer.SetDelay(1000);
+	Rotation()        = BinaryAngle::FromRadians(RandomFloat(-M_PI, M_PI, AntsData::SpawnRandom));
+	DesiredRotation() = Rotation();
+
+	// Periodic events are spread evenly over ants, so tick cost stays flat
+	Schedule(AntsData::PheromoneSpawnDeadline, 1 + m_index % k_pheromoneSpawnDelay);
+	ScheduleSensing();
+	Schedule(AntsData::DeviationResetDeadline, DeviationTime());
+	ScheduleDeviation();
+
+	m_data.takenFoodPos[m_index] = {0, 0};
 }
 
-void Ant::Update(const TileMap &tileMap, const PheromoneMap &pheromoneMap)
+void Ant::Update(TileMap &tileMap, const PheromoneMap &pheromoneMap)
 {
-	m_pheromoneSpawnTimer.Update(1);
-	m_fovCheckTimer.Update(1);
-	m_deviationTimer.Update(1);
-	m_deviationResetTimer.Update(1);
-
-	if ( m_deviationTimer.IsElapsed())
+	if ( IsDue(AntsData::DeviationDeadline))
 	{
-		m_ignorePheromones = true;
-		m_deviationTimer.Reset();
-		m_deviationResetTimer.Reset();
-		RandomizeDeviationDelay();
+		SetFlag(Flag::IgnorePheromones, true);
+		Schedule(AntsData::DeviationResetDeadline, DeviationTime());
+		ScheduleDeviation();
 	}
 
-	if ( m_deviationResetTimer.IsElapsed())
+	if ( IsDue(AntsData::DeviationResetDeadline))
 	{
-		m_ignorePheromones   = false;
-		m_decreasePheromones = false;
-		m_deviationResetTimer.Reset();
+		SetFlag(Flag::IgnorePheromones, false);
+		SetFlag(Flag::DecreasePheromones, false);
+		Schedule(AntsData::DeviationResetDeadline, DeviationTime());
 	}
 
-	Rotate();
-	Move();
-
 	CheckCollisions(tileMap);
-	if ( m_fovCheckTimer.IsElapsed())
+	if ( IsDue(AntsData::FovCheckDeadline))
 	{
 		CheckInFov(tileMap, pheromoneMap);
-		m_fovCheckTimer.Reset();
+		Schedule(AntsData::FovCheckDeadline, k_fovCheckDelay);
 	}
 
-	m_pheromoneStrength = std::max(m_pheromoneStrength - m_antsSettings.pheromoneStrengthLoss, 0.f);
+	float &pheromoneStrength = m_data.pheromoneStrength[m_index];
+	pheromoneStrength = std::max(pheromoneStrength - m_antsSettings.pheromoneStrengthLoss, 0.f);
 }
 
-void Ant::PostUpdate(TileMap &tileMap, PheromoneMap &pheromoneMap)
+bool Ant::TakeFood(const TileMap &tileMap, PheromoneMap &pheromoneMap)
 {
-	if ( m_takenFood && tileMap.GetTileType(m_takenFoodPos) == TileType::eFood )
+	// Every claim of the tile is done by now, so all claimers see the same amount
+	const int amountLeft = tileMap.GetFoodAmount(m_data.takenFoodPos[m_index]);
+	if ( amountLeft < 0 )
 	{
-		m_pheromoneStrength = 1;
-		m_gotFood           = true;
-		m_state             = SearchForNest;
-		m_takenFood         = false;
-		if ( tileMap.TakeFood(m_takenFoodPos))
-		{
-			pheromoneMap.Set(PheromoneType::Lost, m_takenFoodPos, 255);
-			m_lostPheromoneTimer.Reset();
-			m_spawnLostPheromone = true;
-		}
+		return false;
 	}
 
-	if ( m_deliveredFood )
-	{
-		m_deliveredFood = false;
-		m_decreasePheromones = false;
-//		world.IncDeliveredFoodCount();
-	}
+	GrantFood(amountLeft == 0, pheromoneMap);
+	return true;
+}
 
-	if ( m_pheromoneSpawnTimer.IsElapsed())
-	{
-		SpawnPheromone(pheromoneMap);
-		m_pheromoneSpawnTimer.Reset();
-	}
+void Ant::GrantFood(bool depleted, PheromoneMap &pheromoneMap)
+{
+	m_data.pheromoneStrength[m_index] = 1;
+	SetFlag(Flag::GotFood, true);
+	SetFlag(Flag::TakenFood, false);
+	State() = StateType::SearchForNest;
 
-	if ( m_decreasePheromones )
+	if ( depleted )
 	{
-		DecreasePheromone(pheromoneMap);
+		pheromoneMap.QueueAdd(m_colonyId, PheromoneType::Lost, m_data.takenFoodPos[m_index], 255);
+		SetFlag(Flag::SpawnLostPheromone, true);
 	}
 }
 
-void Ant::Move()
+void Ant::DenyFood()
 {
-	m_prevPos = m_pos;
-
-	const float speed = m_antsSettings.antMovementSpeed;
-
-	m_pos.x += speed * std::cos(m_rotation);
-	m_pos.y += speed * std::sin(m_rotation);
-
-	StayInBounds();
+	SetFlag(Flag::TakenFood, false);
+	State() = StateType::SearchForFood;
 }
 
-void Ant::Rotate()
+void Ant::StoreFood(const TileMap &tileMap)
 {
-	static std::mt19937                          gen{std::random_device()()};
-	static std::uniform_real_distribution<float> def(-1.f, 1.f);
+	SetFlag(Flag::StoreFood, false);
 
-	const float randomRotation = def(gen) * m_antsSettings.antRandomRotation;
+	auto nest       = tileMap.GetTile({m_data.posX[m_index], m_data.posY[m_index]}).GetNest();
+	auto nestColony = nest ? nest->GetColony() : nullptr;
+	if ( nestColony && nestColony->GetId() == m_colonyId )
+	{
+		nest->AddFoodToStorage();
+	}
+}
 
-	m_desiredRotation += randomRotation;
+void Ant::PostUpdate(PheromoneMap &pheromoneMap)
+{
+	if ( HasFlag(Flag::DeliveredFood))
+	{
+		SetFlag(Flag::DeliveredFood, false);
+		SetFlag(Flag::DecreasePheromones, false);
+	}
 
-	float rotationDiff = m_desiredRotation - m_rotation;
-	rotationDiff = std::remainder(rotationDiff, 2.0f * static_cast<float>(M_PI));
+	if ( IsDue(AntsData::PheromoneSpawnDeadline))
+	{
+		SpawnPheromone(pheromoneMap);
+		Schedule(AntsData::PheromoneSpawnDeadline, k_pheromoneSpawnDelay);
+	}
 
-	m_rotation += rotationDiff * m_antsSettings.antRotationSpeed;
+	if ( HasFlag(Flag::DecreasePheromones))
+	{
+		DecreasePheromone(pheromoneMap);
+	}
 }
 
 void Ant::SpawnPheromone(PheromoneMap &pheromoneMap)
 {
-	const IntVec2 pos = {m_pos.x, m_pos.y};//Settings::Instance().GetGlobalSettings().ScreenToWorld(m_prevPos);
+	const IntVec2 pos      = {m_data.posX[m_index], m_data.posY[m_index]};
+	const float   strength = m_data.pheromoneStrength[m_index];
 
-	if ( m_spawnLostPheromone )
+	if ( HasFlag(Flag::SpawnLostPheromone))
 	{
-		pheromoneMap.Add(PheromoneType::Lost, pos.x, pos.y,
-		                 ( k_pheromoneSpawnIntensity ) * m_pheromoneStrength);
+		pheromoneMap.QueueAdd(m_colonyId, PheromoneType::Lost, pos,
+		                      ( k_pheromoneSpawnIntensity ) * strength);
 	}
-	else if ( m_gotFood )
+	else if ( HasFlag(Flag::GotFood))
 	{
-		pheromoneMap.Add(PheromoneType::Food, pos.x, pos.y,
-		                 k_pheromoneSpawnIntensity * m_pheromoneStrength);
+		pheromoneMap.QueueAdd(m_colonyId, PheromoneType::Food, pos,
+		                      k_pheromoneSpawnIntensity * strength);
 	}
 	else
 	{
-		pheromoneMap.Add(PheromoneType::Nest, pos.x, pos.y,
-		                 k_pheromoneSpawnIntensity * m_pheromoneStrength);
+		pheromoneMap.QueueAdd(m_colonyId, PheromoneType::Nest, pos,
+		                      k_pheromoneSpawnIntensity * strength);
 	}
 }
 
 void Ant::DecreasePheromone(PheromoneMap &pheromoneMap) const
 {
-	auto          settings = Settings::Instance();
-	const IntVec2 pos      = {m_pos.x, m_pos.y};
-	pheromoneMap.Substract(PheromoneType::Food, pos.x, pos.y,
-	                       settings.GetPheromoneMapSettings().pheromoneEvaporationRate *
-	                       k_decreasingPheromonesMultiplier);
+	auto          &settings = Settings::Instance();
+	const IntVec2 pos       = {m_data.posX[m_index], m_data.posY[m_index]};
+	pheromoneMap.QueueSubstract(m_colonyId, PheromoneType::Food, pos,
+	                            settings.GetPheromoneMapSettings().pheromoneEvaporationRate *
+	                            k_decreasingPheromonesMultiplier);
 }
 
-void Ant::CheckCollisions(const TileMap &tileMap)
+void Ant::CheckCollisions(TileMap &tileMap)
 {
-	const IntVec2 checkMapPos = {m_pos.x, m_pos.y};//Settings::Instance().GetGlobalSettings().ScreenToWorld(m_pos);
+	float &posX = m_data.posX[m_index];
+	float &posY = m_data.posY[m_index];
+
+	const IntVec2 checkMapPos = {posX, posY};
 
-	switch ( m_state )
+	switch ( State())
 	{
-		case SearchForFood:
+		case StateType::SearchForFood:
 			CheckFoodCollision(tileMap, checkMapPos);
 			break;
-		case SearchForNest:
+		case StateType::SearchForNest:
 			CheckNestCollision(tileMap, checkMapPos);
 			break;
 		default:
@@ -182,14 +183,14 @@ void Ant::CheckCollisions(const TileMap &tileMap)
 
 	if ( !tile.IsPassable())
 	{
-		m_pos = m_prevPos;
+		posX = m_data.prevPosX[m_index];
+		posY = m_data.prevPosY[m_index];
 
-		const IntVec2 prevMapPos = {m_prevPos.x,
-		                            m_prevPos.y};//Settings::Instance().GetGlobalSettings().ScreenToWorld(m_prevPos);
+		const IntVec2 prevMapPos = {posX, posY};
 
 		if ( !tileMap.GetTile(prevMapPos).IsPassable())
 		{
-			m_stuck = true;
+			SetFlag(Flag::Stuck, true);
 		}
 
 		TurnBackward();
@@ -199,26 +200,9 @@ void Ant::CheckCollisions(const TileMap &tileMap)
 
 void Ant::CheckInFov(const TileMap &tileMap, const PheromoneMap &pheromoneMap)
 {
-	// Caching rotations to improve performance
-	float     checkRotations[3][2];
-	for ( int i = -1; i <= 1; ++i )
-	{
-		const float rotation = m_rotation + i * M_PI_4;
-
-		float cosValue = std::cos(rotation);
-		float sinValue = std::sin(rotation);
-
-		if ( rotation > M_PI )
-		{
-			cosValue = -cosValue;
-			sinValue = -sinValue;
-		}
-
-		checkRotations[i + 1][0] = cosValue;
-		checkRotations[i + 1][1] = sinValue;
-	}
-
-	Vector2 checkPos = {0, 0};
+	const Angle   rotation = Rotation();
+	const IntVec2 mapPos   = {m_data.posX[m_index], m_data.posY[m_index]};
+	const auto    state    = State();
 
 	double strongestPheromone = 0;
 	double checkedPheromone   = 0;
@@ -227,149 +211,92 @@ void Ant::CheckInFov(const TileMap &tileMap, const PheromoneMap &pheromoneMap)
 	bool foundPheromone = false;
 
 	int turnSide = 0;
-	int prevSide = 0;
 
-//	float screenToMapRatio        = Settings::Instance().GetGlobalSettings().screenToMapRatio;
-//	float screenToMapInverseRatio = Settings::Instance().GetGlobalSettings().screenToMapInverseRatio;
+	const bool ignorePheromones = HasFlag(Flag::IgnorePheromones);
 
 	PheromoneType searchForPheromoneType = PheromoneType::Nest;
 
-	switch ( m_state )
+	switch ( state )
 	{
-		case SearchForFood:
+		case StateType::SearchForFood:
 			searchForPheromoneType = PheromoneType::Food;
 			break;
-		case SearchForNest:
+		case StateType::SearchForNest:
 			searchForPheromoneType = PheromoneType::Nest;
 			break;
 		default:
 			break;
 	}
 
-	for ( int j = 1; j <= m_antsSettings.antFovRange && !foundObject; ++j )
+	// Cells are ordered by range, so the closest object is found first
+	const auto stencil = m_context.fovStencils.Get(rotation);
+	for ( auto cell = stencil.begin; cell != stencil.end; ++cell )
 	{
-		const float multiplier = static_cast<float>(j); //* screenToMapRatio;
-		for ( int   i          = -j / 2 - 1; i <= j / 2 + 1; ++i )
+		const IntVec2 checkMapPos = {mapPos.x + cell->dx, mapPos.y + cell->dy};
+		const Tile    &tile       = tileMap.GetTile(checkMapPos);
+
+		if ( tile.GetType() == TileType::eFood && state == StateType::SearchForFood )
 		{
-			foundObject = false;
-			// -1 left; 0 forward; 1 right
-			int side = ( i > 0 ) - ( i < 0 );
-
-			checkPos.x = m_pos.x + checkRotations[side + 1][0] * multiplier;
-			checkPos.y = m_pos.y + checkRotations[side + 1][1] * multiplier;
-
-			IntVec2    checkMapPos = {checkPos.x, checkPos.y};
-			const Tile &tile       = tileMap.GetTile(checkMapPos);
-
-			if ( tile.GetType() == TileType::eFood && m_state == SearchForFood )
-			{
-				turnSide    = side;
-				foundObject = true;
-				break;
-			}
-			else if ( tile.GetType() == TileType::eWall && j < 3 )
-			{
-				turnSide    = -side;
-				foundObject = true;
-				break;
-			}
-
-			if ( m_ignorePheromones )
-			{
-				continue;
-			}
-
-			checkedPheromone = pheromoneMap.Get(searchForPheromoneType, checkMapPos);
-
-			if ( m_state == SearchForFood &&
-			     pheromoneMap.Get(PheromoneType::Lost, checkMapPos) > checkedPheromone )
-			{
-				m_decreasePheromones = true;
-				return;
-			}
-
-			if ( checkedPheromone > strongestPheromone )
-			{
-				strongestPheromone = checkedPheromone;
-				turnSide           = side;
-				foundPheromone     = true;
-			}
-			else if ( checkedPheromone == strongestPheromone )
-			{
-				turnSide = ( side == 0 || prevSide == 0 ) ? 0 : side;
-			}
-
-			prevSide = side;
+			turnSide    = cell->side;
+			foundObject = true;
+			break;
+		}
+		else if ( tile.GetType() == TileType::eWall && cell->range < 3 )
+		{
+			turnSide    = -cell->side;
+			foundObject = true;
+			break;
 		}
-	}
-
-	if ( foundPheromone || foundObject )
-	{
-		m_desiredRotation = m_rotation + turnSide * M_PI_4;
-	}
-}
-
-void Ant::ChangeDesiredRotation(Vector2 desiredPos)
-{
-	float dx = desiredPos.x - m_pos.x;
-	float dy = desiredPos.y - m_pos.y;
-	m_desiredRotation = std::atan2(dy, dx);
-}
 
-void Ant::Draw()
-{
-	DrawRectanglePro(Rectangle{m_pos.x, m_pos.y, 2.5f, 1.25f}, {1.25f, 0.625f}, m_rotation * ( 180.0 / M_PI ),
-	                 *m_colorsPtr[m_gotFood]);
-}
+		if ( ignorePheromones )
+		{
+			continue;
+		}
 
-void Ant::StayInBounds()
-{
-	const auto width  = static_cast<float>(Settings::Instance().GetGlobalSettings().mapWidth);
-	//* Settings::Instance().GetGlobalSettings().screenToMapRatio;
-	const auto height = static_cast<float>(Settings::Instance().GetGlobalSettings().mapHeight);
-	//* Settings::Instance().GetGlobalSettings().screenToMapRatio;
+		checkedPheromone = pheromoneMap.Get(m_colonyId, searchForPheromoneType, checkMapPos);
 
-	bool outOfBounds = false;
+		if ( state == StateType::SearchForFood &&
+		     pheromoneMap.Get(m_colonyId, PheromoneType::Lost, checkMapPos) > checkedPheromone )
+		{
+			SetFlag(Flag::DecreasePheromones, true);
+			return;
+		}
 
-	if ( m_pos.x >= width )
-	{
-		m_pos.x = width;
-		outOfBounds = true;
-	}
-	else if ( m_pos.x < 0 )
-	{
-		m_pos.x = 0;
-		outOfBounds = true;
+		if ( checkedPheromone > strongestPheromone )
+		{
+			strongestPheromone = checkedPheromone;
+			turnSide           = cell->side;
+			foundPheromone     = true;
+		}
+		else if ( checkedPheromone == strongestPheromone && cell->side == 0 )
+		{
+			// Ties are resolved in favor of going forward
+			turnSide = 0;
+		}
 	}
 
-	if ( m_pos.y >= height )
-	{
-		m_pos.y = height;
-		outOfBounds = true;
-	}
-	else if ( m_pos.y < 0 )
+	if ( foundPheromone || foundObject )
 	{
-		m_pos.y = 0;
-		outOfBounds = true;
+		DesiredRotation() = rotation + turnSide * BinaryAngle::k_eighthTurn;
 	}
+}
 
-	if ( outOfBounds )
-	{
-		m_pos = m_prevPos;
-		TurnBackward();
-		RandomizeRotation(M_PI_4);
-	}
+void Ant::ChangeDesiredRotation(Vector2 desiredPos)
+{
+	float dx = desiredPos.x - m_data.posX[m_index];
+	float dy = desiredPos.y - m_data.posY[m_index];
+	DesiredRotation() = BinaryAngle::FromRadians(std::atan2(dy, dx));
 }
 
 void Ant::RandomizeRotation(float pi)
 {
-	m_rotation += ( pi * Random::Float(-1.f, 1.f));
-	m_desiredRotation = m_rotation;
+	Rotation() += BinaryAngle::FromRadians(pi * RandomFloat(-1.f, 1.f, AntsData::CollisionRandom));
+	DesiredRotation() = Rotation();
 }
 
 void Ant::RandomizeDesiredRotation(float pi)
 {
-	m_desiredRotation += ( pi * Random::Float(-1.f, 1.f));
+	DesiredRotation() += BinaryAngle::FromRadians(pi * RandomFloat(-1.f, 1.f, AntsData::DesiredRotationRandom));
 }
 
 void Ant::CheckNestCollision(const TileMap &tileMap, const IntVec2 &mapPos)
@@ -378,39 +305,46 @@ void Ant::CheckNestCollision(const TileMap &tileMap, const IntVec2 &mapPos)
 
 	if ( tileType == TileType::eNest )
 	{
-		if ( m_gotFood )
-		{
-			// remake this
-			auto nest       = tileMap.GetTile(mapPos).GetNest();
-			auto nestColony = nest->GetColony();
-			if ( nestColony && nestColony->GetId() == m_colonyId )
-			{
-				nest->AddFoodToStorage();
-			}
-		}
-
-		m_pheromoneStrength  = 1;
-		m_deliveredFood      = true;
-		m_gotFood            = false;
-		m_spawnLostPheromone = false;
-		m_state              = SearchForFood;
+		// Food is stored in StoreFood, serially
+		SetFlag(Flag::StoreFood, HasFlag(Flag::GotFood));
+
+		m_data.pheromoneStrength[m_index] = 1;
+		SetFlag(Flag::DeliveredFood, true);
+		SetFlag(Flag::GotFood, false);
+		SetFlag(Flag::SpawnLostPheromone, false);
+		State() = StateType::SearchForFood;
 		TurnBackward();
 	}
 }
 
-void Ant::CheckFoodCollision(const TileMap &tileMap, const IntVec2 &mapPos)
+void Ant::CheckFoodCollision(TileMap &tileMap, const IntVec2 &mapPos)
 {
 	TileType tileType = tileMap.GetTileType(mapPos);
 
 	if ( tileType == TileType::eFood )
 	{
-		m_takenFood    = true;
-		m_takenFoodPos = mapPos;
-		m_state        = SearchForNest;
+		// Food is settled in TakeFood, when all claims of this tick are done
+		tileMap.ClaimFood(mapPos);
+		SetFlag(Flag::TakenFood, true);
+		m_data.takenFoodPos[m_index] = mapPos;
+		State() = StateType::SearchForNest;
 	}
 }
 
-void Ant::RandomizeDeviationDelay()
+void Ant::ScheduleSensing()
+{
+	// Whole batches sense on the same tick, which keeps branches of a batch coherent
+	Schedule(AntsData::FovCheckDeadline, 1 + ( m_index / AntsData::k_batchSize ) % k_fovCheckDelay);
+}
+
+void Ant::ScheduleDeviation()
+{
+	Schedule(AntsData::DeviationDeadline, static_cast<uint32_t>(RandomInt(m_antsSettings.deviationDelayMin,
+	                                                                      m_antsSettings.deviationDelayMax,
+	                                                                      AntsData::DeviationRandom)));
+}
+
+uint32_t Ant::DeviationTime() const
 {
-	m_deviationTimer.SetDelay(Random::Int(m_antsSettings.deviationDelayMin, m_antsSettings.deviationDelayMax));
+	return static_cast<uint32_t>(m_antsSettings.deviationTime);
 }
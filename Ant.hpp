@@ -2,53 +2,89 @@
 #define ANTS_ANT_HPP
 
 #include <cmath>
+#include <algorithm>
 #include <raylib.h>
 
 #include "PheromoneMap.hpp"
 #include "TileMap.hpp"
 
 #include "IntVec.hpp"
-#include "Timer.hpp"
+#include "Random.hpp"
 
+#include "AntsData.hpp"
+#include "FovStencils.hpp"
 #include "Aliases.hpp"
 
-class AntsSettings;
+struct AntsSettings;
 
-class Ant
+// Everything ants of a colony share during a tick
+struct AntsTickContext
 {
-	enum StateType
-	{
-		Roam, SearchForFood, SearchForNest
-	};
+	AntColonyId colonyId;
 
-public:
-	Ant(AntId id, AntColonyId colonyId, const Vector2 &pos);
+	uint32_t seed;
+	uint32_t tick;
 
-	void Update(const TileMap &tileMap, const PheromoneMap &pheromoneMap);
-	void PostUpdate(TileMap &tileMap, PheromoneMap &pheromoneMap);
+	const AntsSettings &antsSettings;
+	const FovStencils  &fovStencils;
+};
 
-	void SetPos(const Vector2 &pos) { m_pos = pos; }
-	void SetId(AntId newId) { m_id = newId; }
+// Lightweight view over a single ant stored in AntsData,
+// cheap to construct, so it's created on the fly for every ant that needs to be updated
+class Ant
+{
+	using StateType = AntsData::State;
+	using Flag      = AntsData::Flag;
 
-	AntId GetId() const { return m_id; }
-	AntColonyId GetColonyId() const { return m_colonyId; }
+public:
+	Ant(AntsData &data, size_t index, const AntsTickContext &context) :
+			m_data(data), m_index(index), m_colonyId(context.colonyId), m_context(context),
+			m_antsSettings(context.antsSettings) {}
+
+	// Resets ant at this index to its initial state
+	void Init(const Vector2 &pos);
+
+	// Rotation and movement are done beforehand by AntsMovement, for the whole batch of ants
+	// Food is claimed from tiles here, may be called in parallel
+	void Update(TileMap &tileMap, const PheromoneMap &pheromoneMap);
+	// Settles food claimed this tick, has to be called after all ants are updated.
+	// Returns false if the tile was claimed by more ants than it had food,
+	// then the claim has to be settled by GrantFood or DenyFood in a deterministic order
+	bool TakeFood(const TileMap &tileMap, PheromoneMap &pheromoneMap);
+	// Every ant that took food from a tile emptied during this tick spreads Lost pheromone
+	void GrantFood(bool depleted, PheromoneMap &pheromoneMap);
+	void DenyFood();
+	// Stores food in the nest the ant is standing on, has to be called serially
+	void StoreFood(const TileMap &tileMap);
+	// Only queues pheromones, so may be called in parallel
+	void PostUpdate(PheromoneMap &pheromoneMap);
+
+	// Picks the sensing phase by ant index, has to be called when ant changes its index
+	void ScheduleSensing();
+
+	bool IsTakingFood() const { return HasFlag(Flag::TakenFood); }
+	bool IsStoringFood() const { return HasFlag(Flag::StoreFood); }
+	const IntVec2 &GetTakenFoodPos() const { return m_data.takenFoodPos[m_index]; }
+
+	void SetPos(const Vector2 &pos)
+	{
+		m_data.posX[m_index] = pos.x;
+		m_data.posY[m_index] = pos.y;
+	}
 
-	Vector2 GetPos() const { return m_pos; }
-	bool IsGotFood() const { return m_gotFood; }
-	bool IsStuck() const { return m_stuck; }
+	AntId GetId() const { return m_data.id[m_index]; }
+	AntColonyId GetColonyId() const { return m_colonyId; }
 
-	void Draw();
+	Vector2 GetPos() const { return {m_data.posX[m_index], m_data.posY[m_index]}; }
+	bool IsGotFood() const { return HasFlag(Flag::GotFood); }
+	bool IsStuck() const { return HasFlag(Flag::Stuck); }
 
 private:
-	void Rotate();
-	void Move();
-	void StayInBounds();
-
 	void SpawnPheromone(PheromoneMap &pheromoneMap);
 	void DecreasePheromone(PheromoneMap &pheromoneMap) const;
 
 	void CheckInFov(const TileMap &tileMap, const PheromoneMap &pheromoneMap);
-	void CheckCollisions(const TileMap &tileMap);
+	void CheckCollisions(TileMap &tileMap);
 
 	void RandomizeRotation(float pi = M_PI);
 	void RandomizeDesiredRotation(float pi = M_PI);
@@ -56,48 +92,54 @@ private:
 	void ChangeDesiredRotation(Vector2 desiredPos);
 	void TurnBackward()
 	{
-		m_rotation -= M_PI;
-		m_desiredRotation = m_rotation;
+		Rotation() += BinaryAngle::k_halfTurn;
+		DesiredRotation() = Rotation();
 	}
 
 	void CheckNestCollision(const TileMap &tileMap, const IntVec2 &mapPos);
-	void CheckFoodCollision(const TileMap &tileMap, const IntVec2 &mapPos);
-
-	void RandomizeDeviationDelay();
-
-private:
-	AntId       m_id;
-	AntColonyId m_colonyId;
+	void CheckFoodCollision(TileMap &tileMap, const IntVec2 &mapPos);
 
-	Vector2 m_pos;
-	Vector2 m_prevPos;
+	void ScheduleDeviation();
 
-	StateType m_state;
+	inline bool HasFlag(Flag flag) const { return m_data.flags[m_index] & flag; }
+	inline void SetFlag(Flag flag, bool value)
+	{
+		m_data.flags[m_index] = value ? ( m_data.flags[m_index] | flag ) : ( m_data.flags[m_index] & ~flag );
+	}
 
-	const AntsSettings &m_antsSettings;
+	inline float RandomFloat(float min, float max, AntsData::RandomStream stream) const
+	{
+		return Random::CounterFloat(min, max, m_context.seed, m_context.tick, stream, m_data.id[m_index]);
+	}
 
-	const Color *m_colorsPtr[2]{};
+	inline int RandomInt(int min, int max, AntsData::RandomStream stream) const
+	{
+		return Random::CounterInt(min, max, m_context.seed, m_context.tick, stream, m_data.id[m_index]);
+	}
 
-	float m_rotation;
-	float m_desiredRotation;
+	inline bool IsDue(AntsData::DeadlineType type) const
+	{
+		return AntsData::IsDue(m_data.deadlines[type][m_index], m_context.tick);
+	}
+	inline void Schedule(AntsData::DeadlineType type, uint32_t delay)
+	{
+		m_data.deadlines[type][m_index] = static_cast<AntsData::Deadline>(
+				m_context.tick + std::min(delay, AntsData::k_maxDeadlineDelay));
+	}
+	uint32_t DeviationTime() const;
 
-	float m_pheromoneStrength = 1;
+	inline Angle &Rotation() { return m_data.rotation[m_index]; }
+	inline Angle &DesiredRotation() { return m_data.desiredRotation[m_index]; }
+	inline StateType &State() { return m_data.state[m_index]; }
 
-	Timer m_pheromoneSpawnTimer;
-	Timer m_fovCheckTimer;
-	Timer m_deviationTimer;
-	Timer m_deviationResetTimer;
-	Timer m_lostPheromoneTimer;
+private:
+	AntsData &m_data;
+	size_t   m_index;
 
-	bool m_stuck              = false;
-	bool m_gotFood            = false;
-	bool m_takenFood          = false;
-	bool m_deliveredFood      = false;
-	bool m_ignorePheromones   = false;
-	bool m_decreasePheromones = false;
-	bool m_spawnLostPheromone = false;
+	AntColonyId m_colonyId;
 
-	IntVec2 m_takenFoodPos;
+	const AntsTickContext &m_context;
+	const AntsSettings    &m_antsSettings;
 };
 
 
@@ -1,113 +1,395 @@
 #include "AntColony.hpp"
 #include "Ant.hpp"
 
+#include "AntsMovement.hpp"
 #include "Settings.hpp"
+#include "Random.hpp"
+#include "BinaryAngle.hpp"
+#include "Tracer.hpp"
 
 #include "omp.h"
 
-AntColony::AntColony(AntColonyId id, const Vector2 &antsSpawnPos) :
-		m_id(id), m_initialAntsSpawnPos(antsSpawnPos)
+#include <algorithm>
+
+// Storage of ants grows by this many ants at once, multiple of AntsData::k_batchSize
+constexpr size_t k_antsChunkSize = 16 * AntsData::k_batchSize;
+
+// Density map of large population is rebuilt every this many ticks
+constexpr float k_densityUpdateDelay = 10;
+// Alpha of a cell grows by this much with every ant standing on it
+constexpr int   k_densityAlphaStep   = 64;
+
+AntColony::AntColony(AntColonyId id, const Vector2 &antsSpawnPos, PheromoneMap &pheromoneMap) :
+		m_id(id), m_initialAntsSpawnPos(antsSpawnPos), m_pheromoneMap(pheromoneMap)
 {
 	auto &settings          = Settings::Instance();
 	auto &antColonySettings = settings.GetAntColonySettings();
 
-	m_antsAmount    = antColonySettings.antsStartAmount;
 	m_maxAntsAmount = antColonySettings.antsMaxAmount;
+	m_antsAmount    = std::min<size_t>(antColonySettings.antsStartAmount, m_maxAntsAmount);
 	m_antDeathDelay = antColonySettings.antDeathDelay;
 	m_dynamicLife   = antColonySettings.dynamicLife;
 
-	m_ants.resize(m_maxAntsAmount);
-	for ( size_t i = 0; i < m_maxAntsAmount; ++i )
+	m_largePopulation = antColonySettings.largePopulation;
+
+	// Every colony gets its own random sequence
+	m_seed = Random::Mix(static_cast<uint32_t>(settings.GetWorldGenerationSettings().seed) + m_id);
+
+	m_sortInterval = static_cast<uint32_t>(std::max(antColonySettings.antsSortInterval, 0));
+
+	// Storage isn't allocated for max amount up front, it grows by chunks when ants are spawned
+	while ( m_ants.Size() < m_antsAmount )
+	{
+		GrowAnts();
+	}
+
+	const AntsTickContext context = GetTickContext();
+	for ( size_t i = 0; i < m_antsAmount; ++i )
 	{
-		m_ants[i] = std::make_unique<Ant>(i, m_id, antsSpawnPos);
+		Ant(m_ants, i, context).Init(antsSpawnPos);
 	}
 
 	auto &globalSettings = settings.GetGlobalSettings();
-	m_pheromoneMap = std::make_unique<PheromoneMap>(globalSettings.mapWidth, globalSettings.mapHeight,
-	                                                settings.GetPheromoneMapSettings().pheromoneEvaporationRate);
 
-//	m_pheromoneSpawnTimer.SetDelay(settings.GetAntsSettings().pheromoneSpawnDelay);
-//	m_fovCheckTimer.SetDelay(settings.GetAntsSettings().fovCheckDelay);
+	if ( m_largePopulation )
+	{
+		m_densityMap = std::make_unique<ColorMap>(globalSettings.mapWidth, globalSettings.mapHeight, BLANK);
+		m_densityCounts.resize(globalSettings.mapWidth * globalSettings.mapHeight);
+		m_densityUpdateTimer.SetDelay(k_densityUpdateDelay);
+		m_densityUpdateTimer.Elapse();
+	}
+
 	OnAntsAmountChanged();
 }
 
-void AntColony::Update(TileMap &tileMap)
+void AntColony::BeginTick()
 {
 	UpdateTimers();
 
-#pragma omp parallel for default(none) shared(m_ants, tileMap, m_pheromoneMap)
-	for ( size_t i = 0; i < m_antsAmount; ++i )
+	// Rebuilt only when FOV range is changed
+	m_fovStencils.Build(Settings::Instance().GetAntsSettings().antFovRange);
+
+	const auto &antsSettings = Settings::Instance().GetAntsSettings();
+
+	// Map size in the settings may be edited while running, ants stay on the maps the colony was built with
+	m_movementParameters = {
+			antsSettings.antMovementSpeed,
+			antsSettings.antRotationSpeed,
+			antsSettings.antRandomRotation,
+			static_cast<float>(m_pheromoneMap.GetWidth()),
+			static_cast<float>(m_pheromoneMap.GetHeight()),
+			Random::CounterKey(m_seed, m_tick, AntsData::WanderRandom),
+			Random::CounterKey(m_seed, m_tick, AntsData::BounceRandom)
+	};
+}
+
+void AntColony::UpdateAnts(TileMap &tileMap)
+{
+	TraceScope traceScope("Colony ants", m_id);
+
+	const AntsTickContext context       = GetTickContext();
+	const size_t          batchesAmount = ( m_antsAmount + AntsData::k_batchSize - 1 ) / AntsData::k_batchSize;
+
+	// Cost of a batch depends on how many of its ants sense this tick and on what they see,
+	// so every batch is a task, handed out to threads along with batches of other colonies
+#pragma omp taskloop grainsize(1) default(none) shared(m_ants, tileMap, m_pheromoneMap, m_storingAnts, m_movementParameters, context, batchesAmount)
+	for ( size_t batch = 0; batch < batchesAmount; ++batch )
 	{
-		m_ants[i]->Update(tileMap, *m_pheromoneMap);
-		if ( m_ants[i]->IsStuck())
+		const size_t begin = batch * AntsData::k_batchSize;
+		const size_t end   = std::min(begin + AntsData::k_batchSize, m_antsAmount);
+
+		TraceScope batchScope("Ants batch", static_cast<int64_t>(batch));
+
+		AntsMovement::Update(m_ants, begin, end, m_movementParameters);
+
+		for ( size_t i = begin; i < end; ++i )
 		{
-			m_ants[i]->SetPos(m_initialAntsSpawnPos);
+			Ant ant(m_ants, i, context);
+			ant.Update(tileMap, m_pheromoneMap);
+			if ( ant.IsStuck())
+			{
+				ant.SetPos(m_initialAntsSpawnPos);
+			}
+			if ( ant.IsStoringFood())
+			{
+				m_storingAnts.Local().push_back(i);
+			}
 		}
 	}
+}
 
-	for ( size_t i = 0; i < m_antsAmount; ++i )
+void AntColony::StoreFood(TileMap &tileMap)
+{
+	// Ants are collected in parallel, so they are sorted to store food in order of their indices
+	auto &storingAnts = m_storingAntsMerged;
+	storingAnts.clear();
+	for ( size_t thread = 0; thread < m_storingAnts.Size(); ++thread )
 	{
-		m_ants[i]->PostUpdate(tileMap, *m_pheromoneMap);
+		storingAnts.insert(storingAnts.end(), m_storingAnts[thread].begin(), m_storingAnts[thread].end());
+		m_storingAnts[thread].clear();
 	}
+	m_storingAnts.Resize();
+	std::sort(storingAnts.begin(), storingAnts.end());
 
-	m_pheromoneMap->Update();
+	// Amount of ants may grow while food is stored in nests, new ants are appended after the stored ones
+	const AntsTickContext context = GetTickContext();
+	for ( size_t i: storingAnts )
+	{
+		Ant(m_ants, i, context).StoreFood(tileMap);
+	}
 }
 
-void AntColony::SpawnAnt(const Vector2 &pos)
+void AntColony::TakeFood(TileMap &tileMap)
 {
-	if ( m_antsAmount >= Settings::Instance().GetAntColonySettings().antsMaxAmount )
+	TraceScope traceScope("Colony take food", m_id);
+
+	const AntsTickContext context       = GetTickContext();
+	const size_t          batchesAmount = ( m_antsAmount + AntsData::k_batchSize - 1 ) / AntsData::k_batchSize;
+
+#pragma omp taskloop grainsize(1) default(none) shared(m_ants, tileMap, m_pheromoneMap, m_contestedAnts, context, batchesAmount)
+	for ( size_t batch = 0; batch < batchesAmount; ++batch )
 	{
-		return;
+		const size_t begin = batch * AntsData::k_batchSize;
+		const size_t end   = std::min(begin + AntsData::k_batchSize, m_antsAmount);
+
+		for ( size_t i = begin; i < end; ++i )
+		{
+			Ant ant(m_ants, i, context);
+			if ( ant.IsTakingFood() && !ant.TakeFood(tileMap, m_pheromoneMap))
+			{
+				m_contestedAnts.Local().push_back(i);
+				continue;
+			}
+			ant.PostUpdate(m_pheromoneMap);
+		}
+	}
+}
+
+const std::vector<size_t> &AntColony::GatherContestedAnts()
+{
+	auto &contestedAnts = m_contestedAntsMerged;
+	contestedAnts.clear();
+	for ( size_t thread = 0; thread < m_contestedAnts.Size(); ++thread )
+	{
+		contestedAnts.insert(contestedAnts.end(), m_contestedAnts[thread].begin(), m_contestedAnts[thread].end());
+		m_contestedAnts[thread].clear();
+	}
+	m_contestedAnts.Resize();
+
+	return contestedAnts;
+}
+
+void AntColony::SettleContestedFood(size_t index, bool granted)
+{
+	const AntsTickContext context = GetTickContext();
+
+	Ant ant(m_ants, index, context);
+	if ( granted )
+	{
+		ant.GrantFood(true, m_pheromoneMap);
+	}
+	else
+	{
+		ant.DenyFood();
 	}
+	ant.PostUpdate(m_pheromoneMap);
+}
 
+void AntColony::EndTick()
+{
+	TraceScope traceScope("Colony end tick", m_id);
+
+	if ( m_sortInterval > 0 && m_tick % m_sortInterval == 0 )
+	{
+		SortAnts();
+	}
+}
+
+void AntColony::FinishTick()
+{
+	if ( m_largePopulation )
+	{
+		m_densityUpdateTimer.Update(1);
+		if ( m_densityUpdateTimer.IsElapsed())
+		{
+			UpdateDensityMap();
+			m_densityUpdateTimer.Reset();
+		}
+	}
+
+	++m_tick;
+}
+
+AntHandle AntColony::SpawnAnt(const Vector2 &pos)
+{
+	if ( m_antsAmount >= m_maxAntsAmount )
+	{
+		return k_invalidAntHandle;
+	}
+
+	if ( m_antsAmount == m_ants.Size())
+	{
+		GrowAnts();
+	}
+
+	// Slot right after alive ants holds a free id, see RemoveAntAt
+	const size_t index = m_antsAmount;
+	Ant(m_ants, index, GetTickContext()).Init(pos);
 	++m_antsAmount;
 
 	OnAntsAmountChanged();
+
+	return GetAntHandle(index);
+}
+
+void AntColony::RemoveAnt(const AntHandle &handle)
+{
+	if ( IsAlive(handle))
+	{
+		RemoveAntAt(m_antSlots[handle.id]);
+	}
+}
+
+bool AntColony::IsAlive(const AntHandle &handle) const
+{
+	return handle.id < m_antSlots.size() && m_antSlots[handle.id] < m_antsAmount &&
+	       m_antGenerations[handle.id] == handle.generation;
 }
 
-void AntColony::RemoveAnt(AntId id)
+AntHandle AntColony::GetAntHandle(size_t index) const
 {
-	if ( id >= m_antsAmount )
+	const AntId id = m_ants.id[index];
+	return {id, m_antGenerations[id]};
+}
+
+void AntColony::RemoveAntAt(size_t index)
+{
+	if ( index >= m_antsAmount )
 	{
 		return;
 	}
 
-	std::unique_ptr<Ant> &antToRemove = m_ants[id];
-	std::unique_ptr<Ant> &antToSwap   = m_ants[m_antsAmount - 1];
+	// Last ant takes place of the removed one, removed id goes to the freed slot
+	// and is reused by the next spawned ant with the next generation
+	const AntId  id        = m_ants.id[index];
+	const size_t lastIndex = m_antsAmount - 1;
+	const AntId  lastId    = m_ants.id[lastIndex];
+
+	m_ants.Move(lastIndex, index);
+	m_ants.id[index]     = lastId;
+	m_antSlots[lastId]   = static_cast<uint32_t>(index);
+	m_ants.id[lastIndex] = id;
+	m_antSlots[id]       = static_cast<uint32_t>(lastIndex);
 
-	antToRemove = std::make_unique<Ant>(antToSwap->GetId(), m_id, m_initialAntsSpawnPos);
-	antToSwap->SetId(id);
-	antToSwap.swap(antToRemove);
+	++m_antGenerations[id];
 	--m_antsAmount;
 
 	OnAntsAmountChanged();
 }
 
-void AntColony::UpdateTimers()
+void AntColony::GrowAnts()
+{
+	const size_t oldSize = m_ants.Size();
+	const size_t newSize = std::min(oldSize + k_antsChunkSize, m_maxAntsAmount);
+
+	m_ants.Resize(newSize);
+	m_antSlots.resize(newSize);
+	m_antGenerations.resize(newSize);
+	for ( size_t i = oldSize; i < newSize; ++i )
+	{
+		m_ants.id[i]        = static_cast<AntId>(i);
+		m_antSlots[i]       = static_cast<uint32_t>(i);
+		m_antGenerations[i] = 0;
+	}
+}
+
+// Interleaves bits of cell coordinates, so cells close on the map get close codes
+uint32_t MortonCode(uint32_t x, uint32_t y)
 {
-//	m_pheromoneSpawnTimer.Update(1);
-//	m_fovCheckTimer.Update(1);
+	const auto spread = [](uint32_t value)
+	{
+		value &= 0xffff;
+		value = ( value | ( value << 8 )) & 0x00ff00ff;
+		value = ( value | ( value << 4 )) & 0x0f0f0f0f;
+		value = ( value | ( value << 2 )) & 0x33333333;
+		value = ( value | ( value << 1 )) & 0x55555555;
+		return value;
+	};
+	return spread(x) | ( spread(y) << 1 );
+}
+
+void AntColony::SortAnts()
+{
+	// Slot index in lower bits makes keys unique, so the order doesn't depend on the sort algorithm
+	m_sortKeys.resize(m_antsAmount);
+	for ( size_t i = 0; i < m_antsAmount; ++i )
+	{
+		const uint64_t code = MortonCode(static_cast<uint32_t>(m_ants.posX[i]),
+		                                 static_cast<uint32_t>(m_ants.posY[i]));
+		m_sortKeys[i] = ( code << 32 ) | i;
+	}
+	std::sort(m_sortKeys.begin(), m_sortKeys.end());
+
+	m_sortOrder.resize(m_antsAmount);
+	for ( size_t i = 0; i < m_antsAmount; ++i )
+	{
+		m_sortOrder[i] = static_cast<uint32_t>(m_sortKeys[i]);
+	}
+	m_ants.Permute(m_sortOrder);
+
+	const AntsTickContext context = GetTickContext();
+	for ( size_t i = 0; i < m_antsAmount; ++i )
+	{
+		m_antSlots[m_ants.id[i]] = static_cast<uint32_t>(i);
+		// Ants got new batches, so sensing phases are aligned with them again
+		Ant(m_ants, i, context).ScheduleSensing();
+	}
+}
 
+void AntColony::UpdateTimers()
+{
 	m_antDeathTimer.Update(1);
 
 	if ( m_dynamicLife && m_antDeathTimer.IsElapsed())
 	{
-		RemoveAnt(0);
+		// Colony which died out has nobody left to die
+		if ( m_antsAmount > 0 )
+		{
+			RemoveAntAt(0);
+		}
 		m_antDeathTimer.Reset();
 	}
 }
 
-void AntColony::DrawAnts() const
+AntsTickContext AntColony::GetTickContext() const
+{
+	return {m_id, m_seed, m_tick, Settings::Instance().GetAntsSettings(), m_fovStencils};
+}
+
+void AntColony::UpdateDensityMap()
 {
+	const int width  = m_densityMap->GetWidth();
+	const int height = m_densityMap->GetHeight();
+
+	std::fill(m_densityCounts.begin(), m_densityCounts.end(), 0);
 	for ( size_t i = 0; i < m_antsAmount; ++i )
 	{
-		m_ants[i]->Draw();
+		const auto cell  = static_cast<size_t>(m_ants.posY[i]) * width + static_cast<size_t>(m_ants.posX[i]);
+		uint16_t   &count = m_densityCounts[cell];
+		count += count < UINT16_MAX;
 	}
-}
 
-void AntColony::DrawPheromones() const
-{
-	m_pheromoneMap->Draw();
+	const Color color = Settings::Instance().GetAntsSettings().antDefaultColor;
+#pragma omp parallel for default(none) shared(m_densityCounts, m_densityMap, color, width, height)
+	for ( int y = 0; y < height; ++y )
+	{
+		for ( int x = 0; x < width; ++x )
+		{
+			const int alpha = std::min(m_densityCounts[y * width + x] * k_densityAlphaStep, 255);
+			m_densityMap->UnsafeSet(x, y, {color.r, color.g, color.b, static_cast<unsigned char>(alpha)});
+		}
+	}
+	m_densityMap->Update();
 }
 
 void AntColony::OnAntsAmountChanged()
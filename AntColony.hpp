@@ -3,19 +3,24 @@
 
 #include <cstdint>
 #include <vector>
+#include <limits>
 
 #include "Timer.hpp"
+#include "PerThread.hpp"
 
 #include "Nest.hpp"
 #include "PheromoneMap.hpp"
 #include "Aliases.hpp"
 #include "Ant.hpp"
+#include "AntsData.hpp"
+#include "AntsMovement.hpp"
 
 #include "TileMap.hpp"
+#include "ColorMap.hpp"
 
 struct AntColonySettings
 {
-	size_t coloniesAmount  = 1; // didn't work yet
+	size_t coloniesAmount  = 1;
 	int    antsStartAmount = 1000;
 	int    antsMaxAmount   = 2500;
 
@@ -24,27 +29,80 @@ struct AntColonySettings
 	int  foodToSpawnAnt = 10;
 
 	int nestSize = 5;
+
+	// Ants are re-sorted by their position on the map every this many ticks,
+	// so neighbouring ants are updated together and share cache lines. 0 disables sorting
+	int antsSortInterval = 64;
+
+	// For colonies of millions of ants: ants are drawn as density of ants in every cell,
+	// drawing every single ant would take longer than updating them
+	bool largePopulation = false;
 };
 
-class AntColony
+// Refers to a single ant for its whole life, stays valid while ants are reordered.
+// Ids are reused by new ants, generation tells them apart from the removed ones
+struct AntHandle
 {
-public:
-	AntColony(AntColonyId id, const Vector2 &antsSpawnPos);
+	AntId    id;
+	uint16_t generation;
+};
 
-	void Update(TileMap &tileMap);
+constexpr AntHandle k_invalidAntHandle = {std::numeric_limits<AntId>::max(), 0};
 
-	void SpawnAnt(const Vector2 &pos);
-	void RemoveAnt(AntId id);
+class AntColony
+{
+	// Saves and restores state which isn't exposed otherwise
+	friend class Checkpoint;
 
-	void DrawAnts() const;
-	void DrawPheromones() const;
+public:
+	// Pheromone map is shared by all colonies and owned by ColoniesManager
+	AntColony(AntColonyId id, const Vector2 &antsSpawnPos, PheromoneMap &pheromoneMap);
+
+	/* Tick of a colony is split into phases, which ColoniesManager runs for all colonies at once:
+	 * BeginTick, UpdateAnts, StoreFood, TakeFood, settling of contested food, EndTick, FinishTick.
+	 * UpdateAnts, TakeFood and EndTick split their work into tasks, so they are called
+	 * from tasks of one parallel region, everything else is called serially.
+	 * Evaporation and deposits of the shared pheromone map are applied by ColoniesManager */
+	void BeginTick();
+	void UpdateAnts(TileMap &tileMap);
+	// Stores food of ants which reached their nest, in order of their indices
+	void StoreFood(TileMap &tileMap);
+	void TakeFood(TileMap &tileMap);
+	// Indices of ants which claimed food of tiles that didn't have enough for everyone
+	const std::vector<size_t> &GatherContestedAnts();
+	void SettleContestedFood(size_t index, bool granted);
+	void EndTick();
+	void FinishTick();
+
+	// Returns k_invalidAntHandle if colony is full
+	AntHandle SpawnAnt(const Vector2 &pos);
+	void RemoveAnt(const AntHandle &handle);
+
+	bool IsAlive(const AntHandle &handle) const;
+	AntHandle GetAntHandle(size_t index) const;
 
 	AntColonyId GetId() const { return m_id; }
 	size_t GetAntsAmount() const { return m_antsAmount; }
+	const AntsData &GetAnts() const { return m_ants; }
+
+	// Large population is drawn as density of ants in every cell instead of single ants
+	bool IsLargePopulation() const { return m_largePopulation; }
+	ColorMap *GetDensityMap() { return m_densityMap.get(); }
 
 private:
 	void UpdateTimers();
 
+	void RemoveAntAt(size_t index);
+	// Adds a chunk of free slots, the only place where storage of ants is allocated
+	void GrowAnts();
+
+	AntsTickContext GetTickContext() const;
+
+	// Reorders ants along Z-order curve of their cells, ids aren't changed
+	void SortAnts();
+
+	void UpdateDensityMap();
+
 	void OnAntsAmountChanged();
 
 private:
@@ -55,19 +113,39 @@ private:
 	size_t m_antsAmount;
 	size_t m_maxAntsAmount;
 
-	std::vector<std::unique_ptr<Ant>> m_ants;
-	std::unique_ptr<PheromoneMap>     m_pheromoneMap;
+	// Ants [0, m_antsAmount) are alive, the rest of slots hold free ids
+	AntsData                      m_ants;
+	// Index and generation of every ant id
+	std::vector<uint32_t>         m_antSlots;
+	std::vector<uint16_t>         m_antGenerations;
+	PheromoneMap                  &m_pheromoneMap;
 
-	float m_antDeathDelay;
+	FovStencils              m_fovStencils;
+	AntsMovement::Parameters m_movementParameters{};
 
-	// Planned on remaking simulation to be data oriented,
-	// for potentially improved performance, but nah
-//	Timer m_pheromoneSpawnTimer;
-//	Timer m_fovCheckTimer;
+	PerThread<std::vector<size_t>> m_storingAnts;
+	std::vector<size_t>            m_storingAntsMerged;
+	PerThread<std::vector<size_t>> m_contestedAnts;
+	std::vector<size_t>            m_contestedAntsMerged;
+
+	float m_antDeathDelay;
 
 	Timer m_antDeathTimer;
 
+	uint32_t              m_sortInterval;
+	std::vector<uint64_t> m_sortKeys;
+	std::vector<uint32_t> m_sortOrder;
+
+	uint32_t m_seed;
+	uint32_t m_tick = 0;
+
 	bool m_dynamicLife;
+
+	bool                      m_largePopulation;
+	std::unique_ptr<ColorMap> m_densityMap;
+	// Amount of ants in every cell, saturated
+	std::vector<uint16_t>     m_densityCounts;
+	Timer                     m_densityUpdateTimer;
 };
 
 
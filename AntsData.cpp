@@ -0,0 +1,89 @@
+#include "AntsData.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+// Gathers values by order through the byte buffer, types of ants arrays are trivially copyable
+template<typename T>
+void PermuteValues(std::vector<T> &values, const std::vector<uint32_t> &order, std::vector<uint8_t> &buffer)
+{
+	buffer.resize(std::max(buffer.size(), order.size() * sizeof(T)));
+	for ( size_t i = 0; i < order.size(); ++i )
+	{
+		std::memcpy(buffer.data() + i * sizeof(T), &values[order[i]], sizeof(T));
+	}
+	std::memcpy(values.data(), buffer.data(), order.size() * sizeof(T));
+}
+
+void AntsData::Resize(size_t size)
+{
+	posX.resize(size);
+	posY.resize(size);
+	prevPosX.resize(size);
+	prevPosY.resize(size);
+
+	rotation.resize(size);
+	desiredRotation.resize(size);
+
+	pheromoneStrength.resize(size);
+
+	state.resize(size);
+	flags.resize(size);
+
+	for ( auto &deadline: deadlines )
+	{
+		deadline.resize(size);
+	}
+
+	takenFoodPos.resize(size);
+
+	id.resize(size);
+}
+
+void AntsData::Move(size_t from, size_t to)
+{
+	posX[to]     = posX[from];
+	posY[to]     = posY[from];
+	prevPosX[to] = prevPosX[from];
+	prevPosY[to] = prevPosY[from];
+
+	rotation[to]        = rotation[from];
+	desiredRotation[to] = desiredRotation[from];
+
+	pheromoneStrength[to] = pheromoneStrength[from];
+
+	state[to] = state[from];
+	flags[to] = flags[from];
+
+	for ( auto &deadline: deadlines )
+	{
+		deadline[to] = deadline[from];
+	}
+
+	takenFoodPos[to] = takenFoodPos[from];
+}
+
+void AntsData::Permute(const std::vector<uint32_t> &order)
+{
+	PermuteValues(posX, order, m_permuteBuffer);
+	PermuteValues(posY, order, m_permuteBuffer);
+	PermuteValues(prevPosX, order, m_permuteBuffer);
+	PermuteValues(prevPosY, order, m_permuteBuffer);
+
+	PermuteValues(rotation, order, m_permuteBuffer);
+	PermuteValues(desiredRotation, order, m_permuteBuffer);
+
+	PermuteValues(pheromoneStrength, order, m_permuteBuffer);
+
+	PermuteValues(state, order, m_permuteBuffer);
+	PermuteValues(flags, order, m_permuteBuffer);
+
+	for ( auto &deadline: deadlines )
+	{
+		PermuteValues(deadline, order, m_permuteBuffer);
+	}
+
+	PermuteValues(takenFoodPos, order, m_permuteBuffer);
+
+	PermuteValues(id, order, m_permuteBuffer);
+}
@@ -0,0 +1,138 @@
+#ifndef ANTS_ANTSDATA_HPP
+#define ANTS_ANTSDATA_HPP
+
+#include <cstdint>
+#include <vector>
+#include <array>
+
+#include "IntVec.hpp"
+#include "BinaryAngle.hpp"
+#include "Aliases.hpp"
+
+// Structure of arrays holding the state of every ant in a colony,
+// ant with index i is described by the i-th element of every array.
+//
+// Memory budget per ant, which decides how many ants fit in memory and cache:
+//  hot  (read or written on every tick): positions, previous positions, rotations, state, flags, deadlines
+//  cold (touched only on events):        pheromone strength, position of taken food, id
+// AntColony adds 6 more bytes per ant for slot and generation of every id
+struct AntsData
+{
+	// Ants are updated by batches, big enough to keep SIMD lanes busy and small enough to stay in cache
+	static constexpr size_t k_batchSize = 256;
+
+	enum State : uint8_t
+	{
+		Roam, SearchForFood, SearchForNest
+	};
+
+	enum Flag : uint8_t
+	{
+		Stuck              = 1 << 0,
+		GotFood            = 1 << 1,
+		TakenFood          = 1 << 2,
+		DeliveredFood      = 1 << 3,
+		StoreFood          = 1 << 4,
+		IgnorePheromones   = 1 << 5,
+		DecreasePheromones = 1 << 6,
+		SpawnLostPheromone = 1 << 7
+	};
+
+	// Events of every ant are scheduled on the colony tick clock, ant wakes up for an event
+	// only when its deadline tick is reached, instead of counting time on every tick
+	enum DeadlineType
+	{
+		PheromoneSpawnDeadline, FovCheckDeadline, DeviationDeadline, DeviationResetDeadline, DeadlinesAmount
+	};
+
+	// Streams of counter-based random values (see Random::Counter), keyed by ant id and tick,
+	// so values of an ant don't change when ants are moved or sorted
+	enum RandomStream : uint32_t
+	{
+		SpawnRandom, WanderRandom, BounceRandom, CollisionRandom, DeviationRandom, DesiredRotationRandom
+	};
+
+	void Resize(size_t size);
+
+	// Copies state of the ant at index 'from' over the ant at index 'to', ids aren't copied
+	void Move(size_t from, size_t to);
+
+	// Reorders ants, ant at index order[i] goes to index i, ids are reordered too.
+	// Only first order.size() ants are touched
+	void Permute(const std::vector<uint32_t> &order);
+
+	size_t Size() const { return state.size(); }
+
+	// Calls function with every array, ids included, always in the same order. Data is AntsData or const AntsData
+	template<typename Data, typename Function>
+	static void ForEachArray(Data &data, Function &&function);
+
+	// Deadlines keep only low 16 bits of the tick. Every due deadline is rescheduled on the tick it becomes due,
+	// so a deadline is never more than k_maxDeadlineDelay ticks away from the current tick
+	using Deadline = uint16_t;
+	static constexpr uint32_t k_maxDeadlineDelay = INT16_MAX;
+
+	// Handles wrap around of the tick counter
+	static bool IsDue(Deadline deadline, uint32_t tick)
+	{
+		return static_cast<int16_t>(static_cast<Deadline>(tick - deadline)) >= 0;
+	}
+
+	std::vector<float> posX, posY;
+	std::vector<float> prevPosX, prevPosY;
+
+	std::vector<Angle> rotation;
+	std::vector<Angle> desiredRotation;
+
+	std::vector<float> pheromoneStrength;
+
+	std::vector<State>   state;
+	std::vector<uint8_t> flags;
+
+	// Tick at which each event is due next
+	std::array<std::vector<Deadline>, DeadlinesAmount> deadlines;
+
+	std::vector<IntVec2> takenFoodPos;
+
+	// Ids stay the same while ants are reordered, see AntColony::SortAnts
+	std::vector<AntId> id;
+
+	static constexpr size_t k_hotBytesPerAnt = 4 * sizeof(float) + 2 * sizeof(Angle) + sizeof(State) + sizeof(uint8_t) +
+	                                           DeadlinesAmount * sizeof(Deadline);
+	static constexpr size_t k_coldBytesPerAnt = sizeof(float) + sizeof(IntVec2) + sizeof(AntId);
+
+private:
+	// Reused by Permute, so sorting doesn't allocate once it reached the biggest size
+	std::vector<uint8_t> m_permuteBuffer;
+};
+
+template<typename Data, typename Function>
+void AntsData::ForEachArray(Data &data, Function &&function)
+{
+	function(data.posX);
+	function(data.posY);
+	function(data.prevPosX);
+	function(data.prevPosY);
+
+	function(data.rotation);
+	function(data.desiredRotation);
+
+	function(data.pheromoneStrength);
+
+	function(data.state);
+	function(data.flags);
+
+	for ( auto &deadline: data.deadlines )
+	{
+		function(deadline);
+	}
+
+	function(data.takenFoodPos);
+
+	function(data.id);
+}
+
+// Hot state of ant is kept within a half of cache line
+static_assert(AntsData::k_hotBytesPerAnt <= 32);
+
+#endif //ANTS_ANTSDATA_HPP
@@ -0,0 +1,387 @@
+#include "AntsMovement.hpp"
+
+#include <cmath>
+
+#include "Random.hpp"
+#include "BinaryAngle.hpp"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define ANTS_MOVEMENT_X86
+#include <immintrin.h>
+#endif
+
+#if defined(ANTS_MOVEMENT_X86) && ( defined(__GNUC__) || defined(__clang__))
+#define ANTS_MOVEMENT_AVX2
+#define ANTS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+// PI / 4 in binary angle units
+constexpr float k_bounceScale = static_cast<float>(BinaryAngle::k_eighthTurn);
+
+using UpdateFunction = void (*)(AntsData &, size_t, size_t, const AntsMovement::Parameters &);
+
+inline Angle RoundToAngle(float value)
+{
+	return static_cast<Angle>(std::lrint(value));
+}
+
+inline void UpdateAnt(AntsData &data, size_t i, const AntsMovement::Parameters &parameters, float wanderScale)
+{
+	Angle &rotation        = data.rotation[i];
+	Angle &desiredRotation = data.desiredRotation[i];
+
+	const AntId id           = data.id[i];
+	const float wanderRandom = Random::CounterToFloat(Random::Counter(parameters.wanderKey, id), -1.f, 1.f);
+
+	desiredRotation += RoundToAngle(wanderRandom * wanderScale);
+
+	const auto rotationDiff = static_cast<float>(BinaryAngle::Difference(desiredRotation, rotation));
+	rotation += RoundToAngle(rotationDiff * parameters.rotationSpeed);
+
+	float &posX = data.posX[i];
+	float &posY = data.posY[i];
+
+	data.prevPosX[i] = posX;
+	data.prevPosY[i] = posY;
+
+	posX += parameters.movementSpeed * BinaryAngle::Cos(rotation);
+	posY += parameters.movementSpeed * BinaryAngle::Sin(rotation);
+
+	if ( posX >= parameters.width || posX < 0 || posY >= parameters.height || posY < 0 )
+	{
+		posX = data.prevPosX[i];
+		posY = data.prevPosY[i];
+
+		const float bounceRandom = Random::CounterToFloat(Random::Counter(parameters.bounceKey, id), -1.f, 1.f);
+
+		rotation += BinaryAngle::k_halfTurn;
+		rotation += RoundToAngle(bounceRandom * k_bounceScale);
+		desiredRotation = rotation;
+	}
+}
+
+inline float WanderScale(const AntsMovement::Parameters &parameters)
+{
+	return parameters.randomRotation * BinaryAngle::k_radiansToAngle;
+}
+
+void AntsMovement::UpdateScalar(AntsData &data, size_t begin, size_t end, const Parameters &parameters)
+{
+	const float wanderScale = WanderScale(parameters);
+	for ( size_t i = begin; i < end; ++i )
+	{
+		UpdateAnt(data, i, parameters, wanderScale);
+	}
+}
+
+#ifdef ANTS_MOVEMENT_X86
+
+// Sign extends lower 16 bits of every lane
+inline __m128i SignExtendAngles(__m128i angles)
+{
+	return _mm_srai_epi32(_mm_slli_epi32(angles, 16), 16);
+}
+
+inline __m128i LoadAngles4(const Angle *angles)
+{
+	return _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(angles)), _mm_setzero_si128());
+}
+
+inline void StoreAngles4(Angle *angles, __m128i values)
+{
+	const __m128i extended = SignExtendAngles(values);
+	_mm_storel_epi64(reinterpret_cast<__m128i *>(angles), _mm_packs_epi32(extended, extended));
+}
+
+inline __m128i TableIndices(__m128i angles)
+{
+	const __m128i rounded = _mm_add_epi32(angles, _mm_set1_epi32(1 << ( BinaryAngle::k_tableShift - 1 )));
+	return _mm_and_si128(_mm_srli_epi32(rounded, BinaryAngle::k_tableShift),
+	                     _mm_set1_epi32(BinaryAngle::k_tableSize - 1));
+}
+
+// SSE2 has no gather, so table is read lane by lane
+inline void SinCos(__m128i angles, __m128 &sinOut, __m128 &cosOut)
+{
+	alignas(16) int32_t indices[4];
+	_mm_store_si128(reinterpret_cast<__m128i *>(indices), TableIndices(angles));
+
+	const float *table = BinaryAngle::GetSinTable();
+	const float *cosTable = table + BinaryAngle::k_cosineTableShift;
+
+	sinOut = _mm_setr_ps(table[indices[0]], table[indices[1]], table[indices[2]], table[indices[3]]);
+	cosOut = _mm_setr_ps(cosTable[indices[0]], cosTable[indices[1]], cosTable[indices[2]], cosTable[indices[3]]);
+}
+
+inline __m128i Select(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// SSE2 has no 32-bit multiplication, so even and odd lanes are multiplied separately
+inline __m128i MultiplyLow(__m128i a, __m128i b)
+{
+	const __m128i even = _mm_mul_epu32(a, b);
+	const __m128i odd  = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+	                          _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// Same as Random::CounterToFloat(Random::Counter(key, id), -1, 1)
+inline __m128 CounterRandom(uint32_t key, __m128i ids)
+{
+	__m128i x = _mm_xor_si128(_mm_set1_epi32(static_cast<int>(key)), ids);
+	x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+	x = MultiplyLow(x, _mm_set1_epi32(0x7feb352d));
+	x = _mm_xor_si128(x, _mm_srli_epi32(x, 15));
+	x = MultiplyLow(x, _mm_set1_epi32(static_cast<int>(0x846ca68bU)));
+	x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+
+	const __m128 unit = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(x, 8)), _mm_set1_ps(1.f / 16777216.f));
+	return _mm_add_ps(_mm_set1_ps(-1.f), _mm_mul_ps(_mm_set1_ps(2.f), unit));
+}
+
+void UpdateSse2(AntsData &data, size_t begin, size_t end, const AntsMovement::Parameters &parameters)
+{
+	const __m128 movementSpeed = _mm_set1_ps(parameters.movementSpeed);
+	const __m128 rotationSpeed = _mm_set1_ps(parameters.rotationSpeed);
+	const __m128 wanderScale   = _mm_set1_ps(WanderScale(parameters));
+	const __m128 width         = _mm_set1_ps(parameters.width);
+	const __m128 height        = _mm_set1_ps(parameters.height);
+	const __m128 zero          = _mm_setzero_ps();
+
+	size_t i = begin;
+	for ( ; i + 4 <= end; i += 4 )
+	{
+		const __m128i ids = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&data.id[i]));
+
+		// Angles are kept in 32-bit lanes, only lower 16 bits matter
+		__m128i desiredRotation = LoadAngles4(&data.desiredRotation[i]);
+		__m128i rotation        = LoadAngles4(&data.rotation[i]);
+
+		const __m128 wanderRandom = CounterRandom(parameters.wanderKey, ids);
+		desiredRotation = _mm_add_epi32(desiredRotation, _mm_cvtps_epi32(_mm_mul_ps(wanderRandom, wanderScale)));
+
+		const __m128 rotationDiff = _mm_cvtepi32_ps(SignExtendAngles(_mm_sub_epi32(desiredRotation, rotation)));
+		rotation = _mm_add_epi32(rotation, _mm_cvtps_epi32(_mm_mul_ps(rotationDiff, rotationSpeed)));
+
+		const __m128 prevPosX = _mm_loadu_ps(&data.posX[i]);
+		const __m128 prevPosY = _mm_loadu_ps(&data.posY[i]);
+
+		__m128 sinValue, cosValue;
+		SinCos(rotation, sinValue, cosValue);
+
+		__m128 posX = _mm_add_ps(prevPosX, _mm_mul_ps(movementSpeed, cosValue));
+		__m128 posY = _mm_add_ps(prevPosY, _mm_mul_ps(movementSpeed, sinValue));
+
+		const __m128 outOfBounds = _mm_or_ps(_mm_or_ps(_mm_cmpge_ps(posX, width), _mm_cmplt_ps(posX, zero)),
+		                                     _mm_or_ps(_mm_cmpge_ps(posY, height), _mm_cmplt_ps(posY, zero)));
+
+		if ( _mm_movemask_ps(outOfBounds))
+		{
+			const __m128  bounceRandom = CounterRandom(parameters.bounceKey, ids);
+			const __m128i bounced      = _mm_add_epi32(
+					_mm_add_epi32(rotation, _mm_set1_epi32(BinaryAngle::k_halfTurn)),
+					_mm_cvtps_epi32(_mm_mul_ps(bounceRandom, _mm_set1_ps(k_bounceScale))));
+			const __m128i mask         = _mm_castps_si128(outOfBounds);
+
+			posX            = _mm_or_ps(_mm_and_ps(outOfBounds, prevPosX), _mm_andnot_ps(outOfBounds, posX));
+			posY            = _mm_or_ps(_mm_and_ps(outOfBounds, prevPosY), _mm_andnot_ps(outOfBounds, posY));
+			rotation        = Select(mask, bounced, rotation);
+			desiredRotation = Select(mask, bounced, desiredRotation);
+		}
+
+		_mm_storeu_ps(&data.prevPosX[i], prevPosX);
+		_mm_storeu_ps(&data.prevPosY[i], prevPosY);
+		_mm_storeu_ps(&data.posX[i], posX);
+		_mm_storeu_ps(&data.posY[i], posY);
+		StoreAngles4(&data.rotation[i], rotation);
+		StoreAngles4(&data.desiredRotation[i], desiredRotation);
+	}
+
+	AntsMovement::UpdateScalar(data, i, end, parameters);
+}
+
+#endif
+
+#ifdef ANTS_MOVEMENT_AVX2
+
+ANTS_TARGET_AVX2 inline __m256i SignExtendAngles(__m256i angles)
+{
+	return _mm256_srai_epi32(_mm256_slli_epi32(angles, 16), 16);
+}
+
+ANTS_TARGET_AVX2 inline __m256i LoadAngles8(const Angle *angles)
+{
+	return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(angles)));
+}
+
+ANTS_TARGET_AVX2 inline void StoreAngles8(Angle *angles, __m256i values)
+{
+	const __m256i extended = SignExtendAngles(values);
+	// Packing works within 128-bit halves, so lower quadwords of both halves are gathered together
+	const __m256i packed   = _mm256_permute4x64_epi64(_mm256_packs_epi32(extended, extended),
+	                                                  _MM_SHUFFLE(3, 1, 2, 0));
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(angles), _mm256_castsi256_si128(packed));
+}
+
+ANTS_TARGET_AVX2 inline void SinCos(__m256i angles, __m256 &sinOut, __m256 &cosOut)
+{
+	const __m256i rounded = _mm256_add_epi32(angles, _mm256_set1_epi32(1 << ( BinaryAngle::k_tableShift - 1 )));
+	const __m256i indices = _mm256_and_si256(_mm256_srli_epi32(rounded, BinaryAngle::k_tableShift),
+	                                         _mm256_set1_epi32(BinaryAngle::k_tableSize - 1));
+
+	const float *table = BinaryAngle::GetSinTable();
+	sinOut = _mm256_i32gather_ps(table, indices, 4);
+	cosOut = _mm256_i32gather_ps(table + BinaryAngle::k_cosineTableShift, indices, 4);
+}
+
+ANTS_TARGET_AVX2 inline __m256 CounterRandom(uint32_t key, __m256i ids)
+{
+	__m256i x = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(key)), ids);
+	x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+	x = _mm256_mullo_epi32(x, _mm256_set1_epi32(0x7feb352d));
+	x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+	x = _mm256_mullo_epi32(x, _mm256_set1_epi32(static_cast<int>(0x846ca68bU)));
+	x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+
+	const __m256 unit = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(x, 8)), _mm256_set1_ps(1.f / 16777216.f));
+	return _mm256_add_ps(_mm256_set1_ps(-1.f), _mm256_mul_ps(_mm256_set1_ps(2.f), unit));
+}
+
+ANTS_TARGET_AVX2 void UpdateAvx2(AntsData &data, size_t begin, size_t end, const AntsMovement::Parameters &parameters)
+{
+	const __m256 movementSpeed = _mm256_set1_ps(parameters.movementSpeed);
+	const __m256 rotationSpeed = _mm256_set1_ps(parameters.rotationSpeed);
+	const __m256 wanderScale   = _mm256_set1_ps(WanderScale(parameters));
+	const __m256 width         = _mm256_set1_ps(parameters.width);
+	const __m256 height        = _mm256_set1_ps(parameters.height);
+	const __m256 zero          = _mm256_setzero_ps();
+
+	size_t i = begin;
+	for ( ; i + 8 <= end; i += 8 )
+	{
+		const __m256i ids = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&data.id[i]));
+
+		__m256i desiredRotation = LoadAngles8(&data.desiredRotation[i]);
+		__m256i rotation        = LoadAngles8(&data.rotation[i]);
+
+		const __m256 wanderRandom = CounterRandom(parameters.wanderKey, ids);
+		desiredRotation = _mm256_add_epi32(desiredRotation,
+		                                   _mm256_cvtps_epi32(_mm256_mul_ps(wanderRandom, wanderScale)));
+
+		const __m256 rotationDiff = _mm256_cvtepi32_ps(
+				SignExtendAngles(_mm256_sub_epi32(desiredRotation, rotation)));
+		rotation = _mm256_add_epi32(rotation, _mm256_cvtps_epi32(_mm256_mul_ps(rotationDiff, rotationSpeed)));
+
+		const __m256 prevPosX = _mm256_loadu_ps(&data.posX[i]);
+		const __m256 prevPosY = _mm256_loadu_ps(&data.posY[i]);
+
+		__m256 sinValue, cosValue;
+		SinCos(rotation, sinValue, cosValue);
+
+		// No FMA here, so positions stay bit-identical to the scalar implementation
+		__m256 posX = _mm256_add_ps(prevPosX, _mm256_mul_ps(movementSpeed, cosValue));
+		__m256 posY = _mm256_add_ps(prevPosY, _mm256_mul_ps(movementSpeed, sinValue));
+
+		const __m256 outOfBounds = _mm256_or_ps(
+				_mm256_or_ps(_mm256_cmp_ps(posX, width, _CMP_GE_OQ), _mm256_cmp_ps(posX, zero, _CMP_LT_OQ)),
+				_mm256_or_ps(_mm256_cmp_ps(posY, height, _CMP_GE_OQ), _mm256_cmp_ps(posY, zero, _CMP_LT_OQ)));
+
+		if ( _mm256_movemask_ps(outOfBounds))
+		{
+			const __m256  bounceRandom = CounterRandom(parameters.bounceKey, ids);
+			const __m256i bounced      = _mm256_add_epi32(
+					_mm256_add_epi32(rotation, _mm256_set1_epi32(BinaryAngle::k_halfTurn)),
+					_mm256_cvtps_epi32(_mm256_mul_ps(bounceRandom, _mm256_set1_ps(k_bounceScale))));
+			const __m256i mask         = _mm256_castps_si256(outOfBounds);
+
+			posX            = _mm256_blendv_ps(posX, prevPosX, outOfBounds);
+			posY            = _mm256_blendv_ps(posY, prevPosY, outOfBounds);
+			rotation        = _mm256_blendv_epi8(rotation, bounced, mask);
+			desiredRotation = _mm256_blendv_epi8(desiredRotation, bounced, mask);
+		}
+
+		_mm256_storeu_ps(&data.prevPosX[i], prevPosX);
+		_mm256_storeu_ps(&data.prevPosY[i], prevPosY);
+		_mm256_storeu_ps(&data.posX[i], posX);
+		_mm256_storeu_ps(&data.posY[i], posY);
+		StoreAngles8(&data.rotation[i], rotation);
+		StoreAngles8(&data.desiredRotation[i], desiredRotation);
+	}
+
+	UpdateSse2(data, i, end, parameters);
+}
+
+#endif
+
+UpdateFunction GetUpdateFunction(AntsMovement::Implementation implementation)
+{
+	switch ( implementation )
+	{
+#ifdef ANTS_MOVEMENT_AVX2
+		case AntsMovement::Implementation::Avx2:
+			return UpdateAvx2;
+#endif
+#ifdef ANTS_MOVEMENT_X86
+		case AntsMovement::Implementation::Sse2:
+			return UpdateSse2;
+#endif
+		default:
+			return AntsMovement::UpdateScalar;
+	}
+}
+
+AntsMovement::Implementation GetBestImplementation()
+{
+	if ( AntsMovement::IsSupported(AntsMovement::Implementation::Avx2))
+	{
+		return AntsMovement::Implementation::Avx2;
+	}
+	if ( AntsMovement::IsSupported(AntsMovement::Implementation::Sse2))
+	{
+		return AntsMovement::Implementation::Sse2;
+	}
+	return AntsMovement::Implementation::Scalar;
+}
+
+static AntsMovement::Implementation s_implementation = GetBestImplementation();
+static UpdateFunction               s_updateFunction = GetUpdateFunction(s_implementation);
+
+void AntsMovement::Update(AntsData &data, size_t begin, size_t end, const Parameters &parameters)
+{
+	s_updateFunction(data, begin, end, parameters);
+}
+
+void AntsMovement::SetImplementation(Implementation implementation)
+{
+	s_implementation = IsSupported(implementation) ? implementation : GetBestImplementation();
+	s_updateFunction = GetUpdateFunction(s_implementation);
+}
+
+AntsMovement::Implementation AntsMovement::GetImplementation()
+{
+	return s_implementation;
+}
+
+bool AntsMovement::IsSupported(Implementation implementation)
+{
+	switch ( implementation )
+	{
+		case Implementation::Avx2:
+#ifdef ANTS_MOVEMENT_AVX2
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2");
+#else
+			return false;
+#endif
+		case Implementation::Sse2:
+#ifdef ANTS_MOVEMENT_X86
+			return true;
+#else
+			return false;
+#endif
+		default:
+			return true;
+	}
+}
@@ -0,0 +1,47 @@
+#ifndef ANTS_ANTSMOVEMENT_HPP
+#define ANTS_ANTSMOVEMENT_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "AntsData.hpp"
+
+/* Batched rotation smoothing, position integration and bounds check of ants.
+ * Vectorized implementations process 8 (AVX2) or 4 (SSE2) ants at once and are chosen at runtime,
+ * the scalar one is kept as a reference.
+ * Headings are binary angles and sin/cos come from BinaryAngle table, all implementations
+ * do the same float operations in the same order, so their results are bit-identical. */
+namespace AntsMovement
+{
+	enum class Implementation
+	{
+		Scalar, Sse2, Avx2
+	};
+
+	struct Parameters
+	{
+		float movementSpeed;
+		float rotationSpeed;
+		// In radians, converted to binary angle units by implementations
+		float randomRotation;
+
+		float width;
+		float height;
+
+		// Random::CounterKey of this tick for AntsData::WanderRandom and AntsData::BounceRandom streams,
+		// random values are generated in place, so vectorized and scalar implementations get the same ones
+		uint32_t wanderKey;
+		uint32_t bounceKey;
+	};
+
+	void Update(AntsData &data, size_t begin, size_t end, const Parameters &parameters);
+
+	void UpdateScalar(AntsData &data, size_t begin, size_t end, const Parameters &parameters);
+
+	// Falls back to the best supported implementation if requested one isn't supported by CPU
+	void SetImplementation(Implementation implementation);
+	Implementation GetImplementation();
+	bool IsSupported(Implementation implementation);
+}
+
+#endif //ANTS_ANTSMOVEMENT_HPP
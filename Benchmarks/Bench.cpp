@@ -0,0 +1,533 @@
+// Times hot paths of the simulation on fixed, seeded worlds and writes the results as JSON.
+// Usage: Ants-bench [-o results.json] [-r repetitions] [-w warmup] [-f filter]
+//        Ants-bench compare <baseline.json> <current.json> [threshold %]
+// Compare exits with 1 when a case got slower than the threshold (10% by default), with 2 on bad input.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <omp.h>
+
+#include "Settings.hpp"
+#include "World.hpp"
+#include "ColoniesManager.hpp"
+#include "Ant.hpp"
+#include "Brush.hpp"
+#include "Random.hpp"
+
+using json = nlohmann::json;
+
+constexpr uint32_t k_seed = 1;
+// Ants leave the nest and lay trails for this many ticks before anything is timed
+constexpr uint32_t k_warmupTicks = 200;
+
+struct Result
+{
+	std::string name;
+	// Calls of the timed body per repetition
+	int    iterations;
+	// Things one call processes, like ants or cells, 0 if there is no such count
+	double items;
+	double minMs;
+	double medianMs;
+	double meanMs;
+};
+
+class Bench
+{
+public:
+	Bench(int warmup, int repetitions, std::string filter) :
+			m_warmup(warmup), m_repetitions(repetitions), m_filter(std::move(filter)) {}
+
+	bool IsSelected(const std::string &name) const
+	{
+		return m_filter.empty() || name.find(m_filter) != std::string::npos;
+	}
+
+	// Body is called warmup times, then iterations times per every repetition,
+	// time of a call is the median of repetitions
+	void Measure(const std::string &name, int iterations, double items, const std::function<void()> &body)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		for ( int i = 0; i < m_warmup; ++i )
+		{
+			body();
+		}
+
+		std::vector<double> times;
+		for ( int repetition = 0; repetition < m_repetitions; ++repetition )
+		{
+			const auto start = Clock::now();
+			for ( int i = 0; i < iterations; ++i )
+			{
+				body();
+			}
+			times.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count() / iterations);
+		}
+		std::sort(times.begin(), times.end());
+
+		double sum = 0;
+		for ( double time: times )
+		{
+			sum += time;
+		}
+
+		Result result{name, iterations, items, times.front(), times[times.size() / 2], sum / times.size()};
+		std::printf("%-40s %12.4f ms", name.c_str(), result.medianMs);
+		if ( items > 0 )
+		{
+			std::printf(" %10.2f ns/item", result.medianMs * 1e6 / items);
+		}
+		std::printf("\n");
+		std::fflush(stdout);
+
+		m_results.push_back(result);
+	}
+
+	json ToJson() const
+	{
+		json results = json::array();
+		for ( const auto &result: m_results )
+		{
+			results.push_back({{"name", result.name},
+			                   {"iterations", result.iterations},
+			                   {"items", result.items},
+			                   {"min_ms", result.minMs},
+			                   {"median_ms", result.medianMs},
+			                   {"mean_ms", result.meanMs}});
+		}
+
+		return {{"seed", k_seed},
+		        {"threads", omp_get_max_threads()},
+		        {"warmup", m_warmup},
+		        {"repetitions", m_repetitions},
+		        {"results", results}};
+	}
+
+private:
+	int         m_warmup;
+	int         m_repetitions;
+	std::string m_filter;
+
+	std::vector<Result> m_results;
+};
+
+void ResetSettings(Settings &settings, int width, int height)
+{
+	settings.Reset();
+	settings.GetGlobalSettings().mapWidth      = width;
+	settings.GetGlobalSettings().mapHeight     = height;
+	settings.GetWorldGenerationSettings().seed = k_seed;
+	Random::Seed(k_seed);
+}
+
+// Whole ticks of one colony, ants sense, move, deposit pheromones and take food
+void BenchColonies(Bench &bench, Settings &settings)
+{
+	struct Case
+	{
+		int  size;
+		int  ants;
+		bool largePopulation;
+	};
+
+	for ( const Case &benchCase: {Case{256, 1000, false}, Case{1024, 20000, false}, Case{2048, 200000, true}})
+	{
+		const std::string name = "colonies.tick/" + std::to_string(benchCase.size) + "/" +
+		                         std::to_string(benchCase.ants);
+		if ( !bench.IsSelected(name))
+		{
+			continue;
+		}
+
+		ResetSettings(settings, benchCase.size, benchCase.size);
+		settings.GetAntColonySettings().antsStartAmount = benchCase.ants;
+		settings.GetAntColonySettings().antsMaxAmount   = benchCase.ants;
+		settings.GetAntColonySettings().largePopulation = benchCase.largePopulation;
+
+		World           world;
+		ColoniesManager coloniesManager(world.GetTileMap());
+		for ( uint32_t i = 0; i < k_warmupTicks; ++i )
+		{
+			coloniesManager.Update(world.GetTileMap());
+		}
+
+		bench.Measure(name, 10, benchCase.ants, [&]()
+		{
+			coloniesManager.Update(world.GetTileMap());
+		});
+	}
+}
+
+// Ant::Update of every ant of one colony on one thread, without movement, deposits, food settlement and sorting
+// of whole ticks. Ants stay where the warmup left them. Update advances the tick on every call, so the usual share
+// of batches senses, sense makes every ant sense on every call, so changes of CheckInFov get their own numbers
+void BenchAnts(Bench &bench, Settings &settings)
+{
+	struct Case
+	{
+		int size;
+		int ants;
+	};
+
+	for ( const Case &benchCase: {Case{256, 1000}, Case{1024, 20000}} )
+	{
+		const std::string suffix     = "/" + std::to_string(benchCase.size) + "/" + std::to_string(benchCase.ants);
+		const std::string updateName = "ants.update" + suffix;
+		const std::string senseName  = "ants.sense" + suffix;
+		if ( !bench.IsSelected(updateName) && !bench.IsSelected(senseName))
+		{
+			continue;
+		}
+
+		ResetSettings(settings, benchCase.size, benchCase.size);
+		settings.GetAntColonySettings().antsStartAmount = benchCase.ants;
+		settings.GetAntColonySettings().antsMaxAmount   = benchCase.ants;
+
+		World           world;
+		ColoniesManager coloniesManager(world.GetTileMap());
+		for ( uint32_t i = 0; i < k_warmupTicks; ++i )
+		{
+			coloniesManager.Update(world.GetTileMap());
+		}
+
+		const AntColony    &colony       = *coloniesManager.GetColonies()[0];
+		const size_t       antsAmount    = colony.GetAntsAmount();
+		const FovStencils  fovStencils(settings.GetAntsSettings().antFovRange);
+		TileMap            &tileMap      = world.GetTileMap();
+		const PheromoneMap &pheromoneMap = coloniesManager.GetPheromoneMap();
+
+		if ( bench.IsSelected(updateName))
+		{
+			AntsData ants = colony.GetAnts();
+			uint32_t tick = k_warmupTicks;
+			bench.Measure(updateName, 10, static_cast<double>(antsAmount), [&]()
+			{
+				const AntsTickContext context{0, k_seed, tick++, settings.GetAntsSettings(), fovStencils};
+				for ( size_t i = 0; i < antsAmount; ++i )
+				{
+					Ant(ants, i, context).Update(tileMap, pheromoneMap);
+				}
+			});
+		}
+
+		if ( bench.IsSelected(senseName))
+		{
+			AntsData              ants = colony.GetAnts();
+			const AntsTickContext context{0, k_seed, k_warmupTicks, settings.GetAntsSettings(), fovStencils};
+			bench.Measure(senseName, 10, static_cast<double>(antsAmount), [&]()
+			{
+				for ( size_t i = 0; i < antsAmount; ++i )
+				{
+					ants.deadlines[AntsData::FovCheckDeadline][i] = static_cast<AntsData::Deadline>(context.tick);
+					Ant(ants, i, context).Update(tileMap, pheromoneMap);
+				}
+			});
+		}
+	}
+}
+
+// One evaporation sweep is due every 10 ticks of the map, colors are recomputed every 50 ticks
+void BenchPheromones(Bench &bench, Settings &settings)
+{
+	for ( int size: {512, 2048} )
+	{
+		for ( size_t colonies: {size_t(1), size_t(8)} )
+		{
+			const std::string name = "pheromones.evaporate/" + std::to_string(size) + "/" +
+			                         std::to_string(colonies);
+			if ( !bench.IsSelected(name))
+			{
+				continue;
+			}
+
+			ResetSettings(settings, size, size);
+			PheromoneMap pheromoneMap(size, size, colonies, settings.GetPheromoneMapSettings().pheromoneEvaporationRate);
+
+			std::mt19937                          random(k_seed);
+			std::uniform_real_distribution<float> intensity(0.f, 1.f);
+			for ( int y = 0; y < size; ++y )
+			{
+				for ( int x = 0; x < size; ++x )
+				{
+					for ( size_t colony = 0; colony < colonies; ++colony )
+					{
+						const auto colonyId = static_cast<AntColonyId>(colony);
+						pheromoneMap.Set(colonyId, PheromoneMap::Food, x, y, intensity(random));
+						pheromoneMap.Set(colonyId, PheromoneMap::Nest, x, y, intensity(random));
+					}
+				}
+			}
+
+			bench.Measure(name, 5, static_cast<double>(size) * size * colonies, [&]()
+			{
+				for ( int tick = 0; tick < 10; ++tick )
+				{
+					pheromoneMap.Update();
+					pheromoneMap.ApplyEvaporation();
+				}
+			});
+		}
+	}
+}
+
+// Recoloring of every tile
+void BenchTiles(Bench &bench, Settings &settings)
+{
+	for ( int size: {512, 2048} )
+	{
+		const std::string name = "tiles.update/" + std::to_string(size);
+		if ( !bench.IsSelected(name))
+		{
+			continue;
+		}
+
+		ResetSettings(settings, size, size);
+		World world;
+
+		bench.Measure(name, 5, static_cast<double>(size) * size, [&]()
+		{
+			world.GetTileMap().Update();
+		});
+	}
+}
+
+// Strokes of walls over a generated map, every stroke is erased by the next one
+void BenchBrush(Bench &bench, Settings &settings)
+{
+	constexpr int k_size    = 1024;
+	constexpr int k_strokes = 64;
+
+	for ( BrushType brushType: {BrushType::Round, BrushType::Square} )
+	{
+		for ( int brushSize: {5, 50} )
+		{
+			const std::string name = std::string("brush.paint/") + ( brushType == BrushType::Round ? "round" : "square" ) +
+			                         "/" + std::to_string(brushSize);
+			if ( !bench.IsSelected(name))
+			{
+				continue;
+			}
+
+			ResetSettings(settings, k_size, k_size);
+			World world;
+
+			std::mt19937                       random(k_seed);
+			std::uniform_int_distribution<int> coordinate(0, k_size - 1);
+			std::vector<IntVec2>               strokes;
+			for ( int i = 0; i < k_strokes; ++i )
+			{
+				strokes.push_back({coordinate(random), coordinate(random)});
+			}
+
+			Brush wall(TileType::eWall, brushType, brushSize);
+			Brush empty(TileType::eEmpty, brushType, brushSize);
+			bool  erase = false;
+
+			bench.Measure(name, 10, k_strokes, [&]()
+			{
+				Brush &brush = erase ? empty : wall;
+				for ( const IntVec2 &stroke: strokes )
+				{
+					brush.Paint(world.GetTileMap(), stroke.x, stroke.y);
+				}
+				erase = !erase;
+			});
+		}
+	}
+}
+
+// Noise based generation of a whole map
+void BenchWorldGeneration(Bench &bench, Settings &settings)
+{
+	for ( int size: {512, 2048} )
+	{
+		const std::string name = "world.generate/" + std::to_string(size);
+		if ( !bench.IsSelected(name))
+		{
+			continue;
+		}
+
+		ResetSettings(settings, size, size);
+		World world;
+
+		bench.Measure(name, 1, static_cast<double>(size) * size, [&]()
+		{
+			world.GenerateMap();
+		});
+	}
+}
+
+// Building of a world from colors of an image, decoding of the image itself is left out
+void BenchWorldLoading(Bench &bench, Settings &settings)
+{
+	for ( int size: {512, 2048} )
+	{
+		const std::string name = "world.load_colors/" + std::to_string(size);
+		if ( !bench.IsSelected(name))
+		{
+			continue;
+		}
+
+		ResetSettings(settings, size, size);
+		World world;
+
+		std::mt19937                       random(k_seed);
+		std::uniform_int_distribution<int> tile(0, 9);
+		std::vector<Color>                 colors(static_cast<size_t>(size) * size);
+		for ( Color &color: colors )
+		{
+			const int type = tile(random);
+			color = type == 0 ? Color{0, 255, 0, 255} : type == 1 ? Color{255, 255, 255, 255} : Color{0, 0, 0, 255};
+		}
+
+		bench.Measure(name, 1, static_cast<double>(size) * size, [&]()
+		{
+			world.LoadWorldFromColors(settings, colors.data(), size, size);
+		});
+	}
+}
+
+bool LoadResults(const char *filename, std::map<std::string, double> &medians)
+{
+	std::ifstream file(filename);
+	if ( !file )
+	{
+		std::fprintf(stderr, "Can't open %s\n", filename);
+		return false;
+	}
+
+	try
+	{
+		const json results = json::parse(file);
+		for ( const auto &result: results.at("results"))
+		{
+			medians[result.at("name").get<std::string>()] = result.at("median_ms").get<double>();
+		}
+	}
+	catch ( const json::exception &exception )
+	{
+		std::fprintf(stderr, "Can't read results from %s: %s\n", filename, exception.what());
+		return false;
+	}
+
+	return true;
+}
+
+int Compare(const char *baselineFile, const char *currentFile, double threshold)
+{
+	std::map<std::string, double> baseline;
+	std::map<std::string, double> current;
+	if ( !LoadResults(baselineFile, baseline) || !LoadResults(currentFile, current))
+	{
+		return 2;
+	}
+
+	int regressions = 0;
+	std::printf("%-40s %12s %12s %9s\n", "case", "baseline ms", "current ms", "change");
+	for ( const auto &[name, currentMs]: current )
+	{
+		const auto baselineResult = baseline.find(name);
+		if ( baselineResult == baseline.end())
+		{
+			std::printf("%-40s %12s %12.4f %9s\n", name.c_str(), "-", currentMs, "new");
+			continue;
+		}
+
+		const double change       = ( currentMs / baselineResult->second - 1.0 ) * 100.0;
+		const bool   isRegression = change > threshold;
+		regressions += isRegression;
+		std::printf("%-40s %12.4f %12.4f %+8.1f%%%s\n", name.c_str(), baselineResult->second, currentMs, change,
+		            isRegression ? " REGRESSION" : "");
+	}
+	for ( const auto &[name, baselineMs]: baseline )
+	{
+		if ( current.find(name) == current.end())
+		{
+			std::printf("%-40s %12.4f %12s %9s\n", name.c_str(), baselineMs, "-", "missing");
+		}
+	}
+
+	std::printf("%d regressions over %.1f%%\n", regressions, threshold);
+	return regressions > 0 ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+	if ( argc > 1 && std::strcmp(argv[1], "compare") == 0 )
+	{
+		if ( argc < 4 )
+		{
+			std::fprintf(stderr, "Usage: %s compare <baseline.json> <current.json> [threshold %%]\n", argv[0]);
+			return 2;
+		}
+		return Compare(argv[2], argv[3], argc > 4 ? std::atof(argv[4]) : 10.0);
+	}
+
+	std::string output      = "bench.json";
+	std::string filter;
+	int         repetitions = 5;
+	int         warmup      = 2;
+	for ( int i = 1; i + 1 < argc; i += 2 )
+	{
+		if ( std::strcmp(argv[i], "-o") == 0 )
+		{
+			output = argv[i + 1];
+		}
+		else if ( std::strcmp(argv[i], "-r") == 0 )
+		{
+			repetitions = std::max(std::atoi(argv[i + 1]), 1);
+		}
+		else if ( std::strcmp(argv[i], "-w") == 0 )
+		{
+			warmup = std::max(std::atoi(argv[i + 1]), 0);
+		}
+		else if ( std::strcmp(argv[i], "-f") == 0 )
+		{
+			filter = argv[i + 1];
+		}
+		else
+		{
+			std::fprintf(stderr, "Usage: %s [-o results.json] [-r repetitions] [-w warmup] [-f filter]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	// Worlds and colonies report their progress, it would be mixed into the results
+	std::streambuf *coutBuffer = std::cout.rdbuf(nullptr);
+
+	Settings settings;
+	Bench    bench(warmup, repetitions, filter);
+
+	BenchColonies(bench, settings);
+	BenchAnts(bench, settings);
+	BenchPheromones(bench, settings);
+	BenchTiles(bench, settings);
+	BenchBrush(bench, settings);
+	BenchWorldGeneration(bench, settings);
+	BenchWorldLoading(bench, settings);
+
+	std::cout.rdbuf(coutBuffer);
+	std::cout.clear();
+
+	std::ofstream file(output);
+	if ( !file )
+	{
+		std::fprintf(stderr, "Can't write %s\n", output.c_str());
+		return 2;
+	}
+	file << bench.ToJson().dump(4) << std::endl;
+	std::printf("Results written to %s\n", output.c_str());
+
+	return 0;
+}
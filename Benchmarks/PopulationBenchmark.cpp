@@ -0,0 +1,69 @@
+// Measures throughput of colonies of growing size in large population mode, in ant updates per second.
+// Usage: Ants-population-benchmark [ticks] [map width] [map height] [ants...]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "Settings.hpp"
+#include "World.hpp"
+#include "ColoniesManager.hpp"
+
+void Run(Settings &settings, int ticks, int ants)
+{
+	settings.GetAntColonySettings().antsStartAmount = ants;
+	settings.GetAntColonySettings().antsMaxAmount   = ants;
+
+	World           world;
+	ColoniesManager coloniesManager(world.GetTileMap());
+	auto            &colony = *coloniesManager.GetColonies().front();
+
+	// Lets ants spread from the nest before measuring
+	for ( int i = 0; i < ticks / 2; ++i )
+	{
+		coloniesManager.Update(world.GetTileMap());
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	for ( int i = 0; i < ticks; ++i )
+	{
+		coloniesManager.Update(world.GetTileMap());
+	}
+	const auto end = std::chrono::steady_clock::now();
+
+	const double seconds    = std::chrono::duration<double>(end - start).count();
+	const double antUpdates = static_cast<double>(colony.GetAntsAmount()) * ticks;
+	std::printf("%9zu ants: %9.3f ms/tick, %7.2f M ant updates/s\n", colony.GetAntsAmount(),
+	            seconds * 1000.0 / ticks, antUpdates / seconds / 1e6);
+}
+
+int main(int argc, char **argv)
+{
+	const int ticks  = argc > 1 ? std::atoi(argv[1]) : 100;
+	const int width  = argc > 2 ? std::atoi(argv[2]) : 4096;
+	const int height = argc > 3 ? std::atoi(argv[3]) : 4096;
+
+	std::vector<int> populations;
+	for ( int i = 4; i < argc; ++i )
+	{
+		populations.push_back(std::atoi(argv[i]));
+	}
+	if ( populations.empty())
+	{
+		populations = {100000, 1000000, 4000000, 10000000};
+	}
+
+	Settings settings;
+	settings.GetGlobalSettings().mapWidth           = width;
+	settings.GetGlobalSettings().mapHeight          = height;
+	settings.GetAntColonySettings().largePopulation = true;
+
+	std::printf("%dx%d map, %d ticks, %zu hot + %zu cold bytes per ant\n", width, height, ticks,
+	            AntsData::k_hotBytesPerAnt, AntsData::k_coldBytesPerAnt);
+	for ( int ants: populations )
+	{
+		Run(settings, ticks, ants);
+	}
+
+	return 0;
+}
@@ -0,0 +1,162 @@
+// Compares ticks of a large colony with and without periodic re-sorting of ants by position.
+// Usage: Ants-sort-benchmark [ticks] [ants] [map width] [map height]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+
+#include "Settings.hpp"
+#include "World.hpp"
+#include "ColoniesManager.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware cache misses of this thread and its children, where the platform lets us count them
+class CacheMissCounter
+{
+public:
+	CacheMissCounter()
+	{
+#ifdef __linux__
+		perf_event_attr attributes{};
+		attributes.type           = PERF_TYPE_HARDWARE;
+		attributes.size           = sizeof(attributes);
+		attributes.config         = PERF_COUNT_HW_CACHE_MISSES;
+		attributes.disabled       = 1;
+		attributes.inherit        = 1;
+		attributes.exclude_kernel = 1;
+		attributes.exclude_hv     = 1;
+		m_fd = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#endif
+	}
+
+	~CacheMissCounter()
+	{
+#ifdef __linux__
+		if ( m_fd >= 0 )
+		{
+			close(m_fd);
+		}
+#endif
+	}
+
+	bool IsAvailable() const { return m_fd >= 0; }
+
+	void Start()
+	{
+#ifdef __linux__
+		if ( IsAvailable())
+		{
+			ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+			ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+		}
+#endif
+	}
+
+	long long Stop()
+	{
+		long long count = 0;
+#ifdef __linux__
+		if ( IsAvailable())
+		{
+			ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+			if ( read(m_fd, &count, sizeof(count)) != sizeof(count))
+			{
+				count = 0;
+			}
+		}
+#endif
+		return count;
+	}
+
+private:
+	int m_fd = -1;
+};
+
+// Average amount of distinct 64-byte lines of a float map touched by ants of one update batch
+double LinesPerBatch(const AntColony &colony, int mapWidth)
+{
+	const AntsData &ants = colony.GetAnts();
+
+	std::vector<int64_t> lines;
+	size_t               linesAmount = 0;
+	size_t               batches     = 0;
+	for ( size_t begin = 0; begin < colony.GetAntsAmount(); begin += AntsData::k_batchSize )
+	{
+		const size_t end = std::min(begin + AntsData::k_batchSize, colony.GetAntsAmount());
+
+		lines.clear();
+		for ( size_t i = begin; i < end; ++i )
+		{
+			const auto cell = static_cast<int64_t>(ants.posY[i]) * mapWidth + static_cast<int64_t>(ants.posX[i]);
+			lines.push_back(cell * static_cast<int64_t>(sizeof(float)) / 64);
+		}
+		std::sort(lines.begin(), lines.end());
+		linesAmount += std::unique(lines.begin(), lines.end()) - lines.begin();
+		++batches;
+	}
+	return batches ? static_cast<double>(linesAmount) / static_cast<double>(batches) : 0;
+}
+
+void Run(Settings &settings, int ticks, int sortInterval)
+{
+	settings.GetAntColonySettings().antsSortInterval = sortInterval;
+
+	World           world;
+	ColoniesManager coloniesManager(world.GetTileMap());
+	auto            &colony = *coloniesManager.GetColonies().front();
+
+	// Lets ants spread from the nest before measuring
+	for ( int i = 0; i < ticks / 2; ++i )
+	{
+		coloniesManager.Update(world.GetTileMap());
+	}
+
+	CacheMissCounter cacheMisses;
+	cacheMisses.Start();
+	const auto start = std::chrono::steady_clock::now();
+	for ( int i = 0; i < ticks; ++i )
+	{
+		coloniesManager.Update(world.GetTileMap());
+	}
+	const auto      end    = std::chrono::steady_clock::now();
+	const long long misses = cacheMisses.Stop();
+
+	const double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+	std::printf("sort interval %4d: %8.3f ms/tick, %6.1f cache lines per batch, ", sortInterval,
+	            milliseconds / ticks, LinesPerBatch(colony, static_cast<int>(settings.GetGlobalSettings().mapWidth)));
+	if ( cacheMisses.IsAvailable())
+	{
+		std::printf("%lld cache misses per tick\n", misses / ticks);
+	}
+	else
+	{
+		std::printf("cache misses not available\n");
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const int ticks  = argc > 1 ? std::atoi(argv[1]) : 500;
+	const int ants   = argc > 2 ? std::atoi(argv[2]) : 60000;
+	const int width  = argc > 3 ? std::atoi(argv[3]) : 2048;
+	const int height = argc > 4 ? std::atoi(argv[4]) : 2048;
+
+	Settings settings;
+	settings.GetGlobalSettings().mapWidth            = width;
+	settings.GetGlobalSettings().mapHeight           = height;
+	settings.GetAntColonySettings().antsStartAmount = ants;
+	settings.GetAntColonySettings().antsMaxAmount   = ants;
+
+	std::printf("%d ants on %dx%d map, %d ticks\n", ants, width, height, ticks);
+	Run(settings, ticks, 0);
+	Run(settings, ticks, 64);
+
+	return 0;
+}
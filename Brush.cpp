@@ -1,6 +1,7 @@
 #include "Brush.hpp"
 
 #include "TileMap.hpp"
+#include "Profiler.hpp"
 
 void PaintPoint(TileMap &tileMap, Brush &brush, int x, int y)
 {
@@ -44,6 +45,8 @@ void PaintRound(TileMap &tileMap, Brush &brush, int x, int y)
 
 void Brush::Paint(TileMap &tileMap, int x, int y)
 {
+	ProfileScope profileScope(Profiler::BrushPaint);
+
 	switch ( m_brushType )
 	{
 		case Point:
@@ -0,0 +1,650 @@
+#include "Checkpoint.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "MappedFile.hpp"
+
+// Deflate vendored with raylib. raylib builds it too, so its functions are renamed,
+// otherwise they would clash when the core is linked with raylib
+#define sdefl_bound AntsSdeflBound
+#define sdeflate    AntsSdeflate
+#define zsdeflate   AntsZsdeflate
+#define sinflate    AntsSinflate
+#define zsinflate   AntsZsinflate
+#define SDEFL_IMPLEMENTATION
+#include <external/sdefl.h>
+#define SINFL_IMPLEMENTATION
+#define SINFL_NO_SIMD
+#include <external/sinfl.h>
+
+constexpr char k_magic[8] = {'A', 'N', 'T', 'S', 'C', 'K', 'P', 'T'};
+
+// Copies of big sections are split between threads, so pages of a mapped file are read in parallel
+constexpr size_t k_copyChunkSize = size_t(1) << 20;
+
+// Compressed sections are split into chunks, which are inflated in parallel.
+// Fastest level, checkpoints are mostly sparse pheromones and empty tiles, which compress well anyway
+constexpr size_t k_deflateChunkSize = size_t(1) << 20;
+constexpr int    k_deflateLevel     = SDEFL_LVL_MIN;
+// Inflating reads a few bytes past the end of a chunk, so they have to be in the file
+constexpr size_t k_inflateReadAhead = 16;
+
+struct Checkpoint::Header
+{
+	char     magic[8];
+	uint32_t version;
+	uint32_t sectionsAmount;
+	uint64_t tick;
+};
+
+// Compressed section starts with stored sizes of its chunks as uint64_t, followed by the chunks.
+// Every chunk inflates to k_deflateChunkSize bytes but the last one
+struct Checkpoint::SectionEntry
+{
+	SectionKey key;
+	Encoding   encoding;
+	uint32_t   padding;
+	uint64_t   offset;
+	// Bytes in the file, size of the section once it's decoded
+	uint64_t   storedSize;
+	uint64_t   size;
+};
+
+struct Checkpoint::NestState
+{
+	int32_t id;
+	// -1 for nests without colony
+	int32_t colonyId;
+	int32_t x, y;
+	int32_t foodStored;
+	int32_t foodDelivered;
+};
+
+struct Checkpoint::PheromoneState
+{
+	uint64_t coloniesAmount;
+	float    updateTime;
+	float    visualUpdateTime;
+	uint32_t evaporationPending;
+	uint32_t padding;
+};
+
+struct Checkpoint::ColonyState
+{
+	uint32_t id;
+	uint32_t seed;
+	uint32_t tick;
+	float    antDeathTime;
+	float    densityUpdateTime;
+	uint32_t padding;
+	uint64_t antsAmount;
+	// Size of the storage of ants, slots past the alive ants hold free ids
+	uint64_t capacity;
+};
+
+uint64_t Align(uint64_t offset)
+{
+	return ( offset + Checkpoint::k_alignment - 1 ) / Checkpoint::k_alignment * Checkpoint::k_alignment;
+}
+
+void CopyParallel(uint8_t *destination, const uint8_t *source, size_t size)
+{
+	const auto chunksAmount = static_cast<long>(( size + k_copyChunkSize - 1 ) / k_copyChunkSize);
+#pragma omp parallel for default(none) shared(destination, source, size, chunksAmount)
+	for ( long chunk = 0; chunk < chunksAmount; ++chunk )
+	{
+		const size_t begin = static_cast<size_t>(chunk) * k_copyChunkSize;
+		const size_t end   = std::min(begin + k_copyChunkSize, size);
+		std::memcpy(destination + begin, source + begin, end - begin);
+	}
+}
+
+// Leaves output empty when the data doesn't get smaller
+void Compress(const uint8_t *data, size_t size, sdefl &state, std::vector<uint8_t> &output)
+{
+	const size_t chunksAmount = ( size + k_deflateChunkSize - 1 ) / k_deflateChunkSize;
+	output.resize(chunksAmount * sizeof(uint64_t));
+	for ( size_t chunk = 0; chunk < chunksAmount && output.size() < size; ++chunk )
+	{
+		const size_t begin     = chunk * k_deflateChunkSize;
+		const int    chunkSize = static_cast<int>(std::min(k_deflateChunkSize, size - begin));
+		const size_t offset    = output.size();
+
+		output.resize(offset + sdefl_bound(chunkSize));
+		const auto storedSize = static_cast<uint64_t>(sdeflate(&state, output.data() + offset, data + begin,
+		                                                       chunkSize, k_deflateLevel));
+		output.resize(offset + storedSize);
+		std::memcpy(output.data() + chunk * sizeof(uint64_t), &storedSize, sizeof(uint64_t));
+	}
+
+	if ( output.size() >= size )
+	{
+		output.clear();
+	}
+}
+
+bool Decompress(const uint8_t *data, uint64_t storedSize, uint8_t *destination, size_t size)
+{
+	const size_t chunksAmount = ( size + k_deflateChunkSize - 1 ) / k_deflateChunkSize;
+	if ( chunksAmount > storedSize / sizeof(uint64_t))
+	{
+		return false;
+	}
+
+	// Chunk c is [offsets[c], offsets[c + 1])
+	std::vector<uint64_t> offsets(chunksAmount + 1, chunksAmount * sizeof(uint64_t));
+	for ( size_t chunk = 0; chunk < chunksAmount; ++chunk )
+	{
+		uint64_t chunkSize;
+		std::memcpy(&chunkSize, data + chunk * sizeof(uint64_t), sizeof(uint64_t));
+		if ( chunkSize > storedSize - offsets[chunk] )
+		{
+			return false;
+		}
+		offsets[chunk + 1] = offsets[chunk] + chunkSize;
+	}
+
+	const auto chunksAmountSigned = static_cast<long>(chunksAmount);
+	bool       inflated           = true;
+#pragma omp parallel for default(none) shared(data, destination, size, offsets, chunksAmountSigned) reduction(&&:inflated)
+	for ( long chunk = 0; chunk < chunksAmountSigned; ++chunk )
+	{
+		const size_t begin     = static_cast<size_t>(chunk) * k_deflateChunkSize;
+		const size_t end       = std::min(begin + k_deflateChunkSize, size);
+		const int    chunkSize = static_cast<int>(end - begin);
+		inflated = sinflate(destination + begin, chunkSize, data + offsets[chunk],
+		                    static_cast<int>(offsets[chunk + 1] - offsets[chunk])) == chunkSize && inflated;
+	}
+	return inflated;
+}
+
+// Validates the header and the table of sections of a mapped checkpoint
+class Checkpoint::Reader
+{
+public:
+	std::string Open(const std::string &filename)
+	{
+		if ( !m_file.Open(filename))
+		{
+			return "can't open " + filename;
+		}
+
+		const size_t fileSize = m_file.GetSize();
+		if ( fileSize < sizeof(Header))
+		{
+			return filename + " isn't a checkpoint";
+		}
+		std::memcpy(&m_header, m_file.GetData(), sizeof(Header));
+		if ( std::memcmp(m_header.magic, k_magic, sizeof(k_magic)) != 0 )
+		{
+			return filename + " isn't a checkpoint";
+		}
+		if ( m_header.version != k_version )
+		{
+			return "checkpoint version " + std::to_string(m_header.version) + " isn't supported, expected " +
+			       std::to_string(k_version);
+		}
+
+		if ( m_header.sectionsAmount > ( fileSize - sizeof(Header)) / sizeof(SectionEntry))
+		{
+			return "checkpoint is truncated";
+		}
+		m_entries.resize(m_header.sectionsAmount);
+		std::memcpy(m_entries.data(), m_file.GetData() + sizeof(Header), m_entries.size() * sizeof(SectionEntry));
+
+		for ( const SectionEntry &entry: m_entries )
+		{
+			if ( entry.offset > fileSize || entry.storedSize > fileSize - entry.offset )
+			{
+				return "checkpoint is truncated";
+			}
+			if (( entry.encoding != Raw || entry.storedSize != entry.size ) && entry.encoding != Deflate )
+			{
+				return "checkpoint is corrupted";
+			}
+		}
+
+		return {};
+	}
+
+	uint64_t GetTick() const { return m_header.tick; }
+
+	// Null if there's no such section
+	const SectionEntry *Find(SectionKey key) const
+	{
+		const auto entry = std::find_if(m_entries.begin(), m_entries.end(), [&key](const SectionEntry &entry)
+		{
+			return entry.key == key;
+		});
+		return entry == m_entries.end() ? nullptr : &*entry;
+	}
+
+	// Raw sections are copied straight from the file, compressed ones are inflated
+	bool Decode(const SectionEntry &entry, void *destination) const
+	{
+		const uint8_t *data = m_file.GetData() + entry.offset;
+		if ( entry.encoding == Raw )
+		{
+			CopyParallel(static_cast<uint8_t *>(destination), data, entry.size);
+			return true;
+		}
+		return Decompress(data, entry.storedSize, static_cast<uint8_t *>(destination), entry.size);
+	}
+
+	// Section has to be exactly the size of the value
+	template<typename T>
+	bool ReadValue(SectionKey key, T &value) const
+	{
+		const SectionEntry *entry = Find(key);
+		return entry != nullptr && entry->size == sizeof(T) && Decode(*entry, &value);
+	}
+
+	// Section has to be exactly the size of values, they are sized by the caller
+	template<typename T>
+	bool ReadArray(SectionKey key, std::vector<T> &values) const
+	{
+		const SectionEntry *entry = Find(key);
+		return entry != nullptr && entry->size == values.size() * sizeof(T) && Decode(*entry, values.data());
+	}
+
+	std::string ReadSettings(Settings &settings) const
+	{
+		const SectionEntry *entry = Find({SectionType::Settings, 0, 0});
+		std::string        json;
+		if ( entry != nullptr )
+		{
+			json.resize(entry->size);
+		}
+		if ( entry == nullptr || !Decode(*entry, json.data()))
+		{
+			return "checkpoint has no settings";
+		}
+
+		try
+		{
+			settings.FromJson(nlohmann::json::parse(json));
+		}
+		catch ( const nlohmann::json::exception &exception )
+		{
+			return std::string("settings of checkpoint can't be read: ") + exception.what();
+		}
+		return {};
+	}
+
+private:
+	MappedFile                m_file;
+	Header                    m_header{};
+	std::vector<SectionEntry> m_entries;
+};
+
+uint8_t *Checkpoint::AddSection(SectionKey key, size_t size)
+{
+	if ( m_sectionsAmount == m_sections.size())
+	{
+		m_sections.emplace_back();
+	}
+
+	Section &section = m_sections[m_sectionsAmount++];
+	section.key = key;
+	section.data.resize(size);
+	return section.data.data();
+}
+
+template<typename T>
+void Checkpoint::AddArray(SectionKey key, const std::vector<T> &values)
+{
+	CopyParallel(AddSection(key, values.size() * sizeof(T)), reinterpret_cast<const uint8_t *>(values.data()),
+	             values.size() * sizeof(T));
+}
+
+void Checkpoint::Capture(const Settings &settings, const World &world, const ColoniesManager &coloniesManager,
+                         uint64_t tick)
+{
+	m_sectionsAmount = 0;
+	m_tick           = tick;
+
+	const std::string settingsJson = settings.ToJson().dump();
+	std::memcpy(AddSection({SectionType::Settings, 0, 0}, settingsJson.size()), settingsJson.data(),
+	            settingsJson.size());
+
+	// Tiles are objects, so they are gathered into grids of types and amounts
+	const TileMap &tileMap     = world.GetTileMap();
+	const auto    width       = static_cast<size_t>(tileMap.GetWidth());
+	const auto    tilesAmount = width * tileMap.GetHeight();
+	uint8_t       *types      = AddSection({SectionType::TileTypes, 0, 0}, tilesAmount);
+	uint8_t       *amounts    = AddSection({SectionType::TileAmounts, 0, 0}, tilesAmount * sizeof(int32_t));
+#pragma omp parallel for default(none) shared(tileMap, width, types, amounts)
+	for ( int y = 0; y < tileMap.GetHeight(); ++y )
+	{
+		for ( int x = 0; x < tileMap.GetWidth(); ++x )
+		{
+			const Tile    &tile  = *tileMap.m_tiles[y][x];
+			const size_t  index  = y * width + x;
+			const int32_t amount = tile.GetAmount();
+			types[index] = static_cast<uint8_t>(tile.GetType());
+			std::memcpy(amounts + index * sizeof(int32_t), &amount, sizeof(int32_t));
+		}
+	}
+
+	std::vector<NestState> nests;
+	for ( const auto &nest: coloniesManager.GetNests())
+	{
+		nests.push_back({nest->m_id, nest->m_colony ? nest->m_colony->GetId() : -1, nest->m_pos.x, nest->m_pos.y,
+		                 nest->m_foodStored, nest->m_foodDelivered});
+	}
+	AddArray({SectionType::Nests, 0, 0}, nests);
+
+	const PheromoneMap   &pheromoneMap = coloniesManager.GetPheromoneMap();
+	const PheromoneState pheromoneState{pheromoneMap.m_coloniesAmount, pheromoneMap.m_updateTimer.GetTime(),
+	                                    pheromoneMap.m_visualUpdateTimer.GetTime(),
+	                                    pheromoneMap.m_evaporationPending, 0};
+	std::memcpy(AddSection({SectionType::PheromoneState, 0, 0}, sizeof(PheromoneState)), &pheromoneState,
+	            sizeof(PheromoneState));
+	AddArray({SectionType::Pheromones, 0, 0}, pheromoneMap.m_pheromones);
+
+	const auto &colonies = coloniesManager.GetColonies();
+	for ( size_t i = 0; i < colonies.size(); ++i )
+	{
+		const AntColony &colony = *colonies[i];
+		const auto      index   = static_cast<uint16_t>(i);
+
+		const ColonyState colonyState{colony.m_id, colony.m_seed, colony.m_tick, colony.m_antDeathTimer.GetTime(),
+		                              colony.m_densityUpdateTimer.GetTime(), 0, colony.m_antsAmount,
+		                              colony.m_ants.Size()};
+		std::memcpy(AddSection({SectionType::ColonyState, index, 0}, sizeof(ColonyState)), &colonyState,
+		            sizeof(ColonyState));
+
+		uint16_t array = 0;
+		AntsData::ForEachArray(colony.m_ants, [this, index, &array](const auto &values)
+		{
+			AddArray({SectionType::Ants, index, array++}, values);
+		});
+		AddArray({SectionType::AntSlots, index, 0}, colony.m_antSlots);
+		AddArray({SectionType::AntGenerations, index, 0}, colony.m_antGenerations);
+	}
+}
+
+bool Checkpoint::Write(const std::string &filename, bool compress) const
+{
+	const std::string temporaryFilename = filename + ".tmp";
+	{
+		std::ofstream file(temporaryFilename, std::ios::binary | std::ios::trunc);
+		if ( !file )
+		{
+			return false;
+		}
+
+		Header header{};
+		std::memcpy(header.magic, k_magic, sizeof(k_magic));
+		header.version        = k_version;
+		header.sectionsAmount = static_cast<uint32_t>(m_sectionsAmount);
+		header.tick           = m_tick;
+
+		// Sizes of compressed sections are known once they are compressed, so the table is written last
+		std::vector<SectionEntry> entries(m_sectionsAmount);
+		file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+		file.write(reinterpret_cast<const char *>(entries.data()),
+		           static_cast<std::streamsize>(entries.size() * sizeof(SectionEntry)));
+
+		static const char      padding[k_alignment] = {};
+		uint64_t               position             = sizeof(Header) + entries.size() * sizeof(SectionEntry);
+		std::unique_ptr<sdefl> deflateState         = compress ? std::make_unique<sdefl>() : nullptr;
+		std::vector<uint8_t>   compressed;
+		for ( size_t i = 0; i < m_sectionsAmount; ++i )
+		{
+			const std::vector<uint8_t> &data = m_sections[i].data;
+
+			compressed.clear();
+			if ( compress )
+			{
+				Compress(data.data(), data.size(), *deflateState, compressed);
+			}
+
+			const bool     isCompressed = !compressed.empty();
+			const uint8_t  *stored      = isCompressed ? compressed.data() : data.data();
+			const uint64_t storedSize   = isCompressed ? compressed.size() : data.size();
+			entries[i] = {m_sections[i].key, isCompressed ? Deflate : Raw, 0, Align(position), storedSize, data.size()};
+
+			file.write(padding, static_cast<std::streamsize>(entries[i].offset - position));
+			file.write(reinterpret_cast<const char *>(stored), static_cast<std::streamsize>(storedSize));
+			position = entries[i].offset + storedSize;
+			if ( isCompressed )
+			{
+				file.write(padding, k_inflateReadAhead);
+				position += k_inflateReadAhead;
+			}
+		}
+
+		file.seekp(sizeof(Header));
+		file.write(reinterpret_cast<const char *>(entries.data()),
+		           static_cast<std::streamsize>(entries.size() * sizeof(SectionEntry)));
+
+		file.close();
+		if ( !file )
+		{
+			std::filesystem::remove(temporaryFilename);
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporaryFilename, filename, error);
+	if ( error )
+	{
+		std::filesystem::remove(temporaryFilename, error);
+		return false;
+	}
+	return true;
+}
+
+size_t Checkpoint::GetSize() const
+{
+	size_t size = 0;
+	for ( size_t i = 0; i < m_sectionsAmount; ++i )
+	{
+		size += m_sections[i].data.size();
+	}
+	return size;
+}
+
+std::string Checkpoint::Load(const std::string &filename, Settings &settings, std::unique_ptr<World> &world,
+                             std::unique_ptr<ColoniesManager> &coloniesManager, uint64_t &tick)
+{
+	Reader      reader;
+	std::string error = reader.Open(filename);
+	if ( !error.empty())
+	{
+		return error;
+	}
+
+	Settings loadedSettings(settings);
+	error = reader.ReadSettings(loadedSettings);
+	if ( !error.empty())
+	{
+		return error;
+	}
+
+	// World and colonies are built as the saved ones were, then their state is overwritten.
+	// They read the settings meanwhile, previous settings are brought back on failure
+	const Settings previousSettings(settings);
+	settings = loadedSettings;
+
+	auto loadedWorld    = std::make_unique<World>(false);
+	auto loadedColonies = std::make_unique<ColoniesManager>(loadedWorld->GetTileMap());
+
+	error = RestoreTiles(reader, loadedWorld->GetTileMap());
+	if ( error.empty())
+	{
+		error = RestoreNests(reader, *loadedColonies);
+	}
+	if ( error.empty())
+	{
+		error = RestorePheromones(reader, loadedColonies->GetPheromoneMap());
+	}
+	auto &colonies = loadedColonies->GetColonies();
+	for ( size_t i = 0; i < colonies.size() && error.empty(); ++i )
+	{
+		error = RestoreColony(reader, static_cast<uint16_t>(i), *colonies[i]);
+	}
+	if ( error.empty() && reader.Find({SectionType::ColonyState, static_cast<uint16_t>(colonies.size()), 0}))
+	{
+		error = "checkpoint has more colonies than its settings";
+	}
+
+	if ( !error.empty())
+	{
+		settings = previousSettings;
+		return error;
+	}
+
+	world           = std::move(loadedWorld);
+	coloniesManager = std::move(loadedColonies);
+	tick            = reader.GetTick();
+	return {};
+}
+
+std::string Checkpoint::LoadSettings(const std::string &filename, Settings &settings)
+{
+	Reader      reader;
+	std::string error = reader.Open(filename);
+	if ( !error.empty())
+	{
+		return error;
+	}
+
+	Settings loadedSettings(settings);
+	error = reader.ReadSettings(loadedSettings);
+	if ( error.empty())
+	{
+		settings = loadedSettings;
+	}
+	return error;
+}
+
+std::string Checkpoint::RestoreTiles(const Reader &reader, TileMap &tileMap)
+{
+	const auto           width       = static_cast<size_t>(tileMap.GetWidth());
+	const auto           tilesAmount = width * tileMap.GetHeight();
+	std::vector<uint8_t> types(tilesAmount);
+	std::vector<int32_t> amounts(tilesAmount);
+	if ( !reader.ReadArray({SectionType::TileTypes, 0, 0}, types) ||
+	     !reader.ReadArray({SectionType::TileAmounts, 0, 0}, amounts))
+	{
+		return "tiles don't match the map size";
+	}
+
+	// Nests were placed by the colonies, tiles of nests have to be where they were
+	for ( int y = 0; y < tileMap.GetHeight(); ++y )
+	{
+		for ( int x = 0; x < tileMap.GetWidth(); ++x )
+		{
+			const size_t index = y * width + x;
+			const auto   type  = static_cast<TileType>(types[index]);
+			Tile         &tile = *tileMap.m_tiles[y][x];
+			if ( type >= TileType::eAmount || ( type == TileType::eNest ) != ( tile.GetType() == TileType::eNest ))
+			{
+				return "tiles don't match the nests";
+			}
+			if ( type != tile.GetType())
+			{
+				tile.ChangeType(type);
+			}
+			tile.m_amount.store(amounts[index], std::memory_order_relaxed);
+		}
+	}
+
+	tileMap.Update();
+	return {};
+}
+
+std::string Checkpoint::RestoreNests(const Reader &reader, ColoniesManager &coloniesManager)
+{
+	const auto             &nests = coloniesManager.GetNests();
+	std::vector<NestState> nestStates(nests.size());
+	if ( !reader.ReadArray({SectionType::Nests, 0, 0}, nestStates))
+	{
+		return "nests don't match the settings";
+	}
+
+	for ( size_t i = 0; i < nests.size(); ++i )
+	{
+		Nest            &nest    = *nests[i];
+		const NestState &state   = nestStates[i];
+		const int32_t   colonyId = nest.m_colony ? nest.m_colony->GetId() : -1;
+		if ( state.id != nest.m_id || state.colonyId != colonyId || state.x != nest.m_pos.x || state.y != nest.m_pos.y )
+		{
+			return "nests don't match the settings";
+		}
+
+		nest.m_foodStored    = state.foodStored;
+		nest.m_foodDelivered = state.foodDelivered;
+	}
+
+	return {};
+}
+
+std::string Checkpoint::RestorePheromones(const Reader &reader, PheromoneMap &pheromoneMap)
+{
+	PheromoneState state{};
+	if ( !reader.ReadValue({SectionType::PheromoneState, 0, 0}, state) ||
+	     state.coloniesAmount != pheromoneMap.m_coloniesAmount ||
+	     !reader.ReadArray({SectionType::Pheromones, 0, 0}, pheromoneMap.m_pheromones))
+	{
+		return "pheromones don't match the settings";
+	}
+
+	pheromoneMap.m_updateTimer.Reset();
+	pheromoneMap.m_updateTimer.Update(state.updateTime);
+	pheromoneMap.m_visualUpdateTimer.Reset();
+	pheromoneMap.m_visualUpdateTimer.Update(state.visualUpdateTime);
+	pheromoneMap.m_evaporationPending = state.evaporationPending != 0;
+
+	pheromoneMap.UpdateColors();
+	return {};
+}
+
+std::string Checkpoint::RestoreColony(const Reader &reader, uint16_t index, AntColony &colony)
+{
+	const std::string error = "ants of colony " + std::to_string(index) + " don't match the settings";
+
+	ColonyState state{};
+	if ( !reader.ReadValue({SectionType::ColonyState, index, 0}, state) || state.id != colony.m_id ||
+	     state.capacity > colony.m_maxAntsAmount || state.antsAmount > state.capacity )
+	{
+		return error;
+	}
+
+	colony.m_ants.Resize(state.capacity);
+	colony.m_antSlots.resize(state.capacity);
+	colony.m_antGenerations.resize(state.capacity);
+
+	bool     restored = true;
+	uint16_t array    = 0;
+	AntsData::ForEachArray(colony.m_ants, [&reader, index, &array, &restored](auto &values)
+	{
+		restored = reader.ReadArray({SectionType::Ants, index, array++}, values) && restored;
+	});
+	if ( !restored || !reader.ReadArray({SectionType::AntSlots, index, 0}, colony.m_antSlots) ||
+	     !reader.ReadArray({SectionType::AntGenerations, index, 0}, colony.m_antGenerations))
+	{
+		return error;
+	}
+
+	colony.m_antsAmount = state.antsAmount;
+	colony.m_seed       = state.seed;
+	colony.m_tick       = state.tick;
+	colony.m_antDeathTimer.Reset();
+	colony.m_antDeathTimer.Update(state.antDeathTime);
+	colony.m_densityUpdateTimer.Reset();
+	colony.m_densityUpdateTimer.Update(state.densityUpdateTime);
+	colony.OnAntsAmountChanged();
+
+	if ( colony.m_largePopulation )
+	{
+		colony.UpdateDensityMap();
+	}
+	return {};
+}
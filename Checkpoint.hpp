@@ -0,0 +1,106 @@
+#ifndef ANTS_CHECKPOINT_HPP
+#define ANTS_CHECKPOINT_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "World.hpp"
+#include "ColoniesManager.hpp"
+#include "Settings.hpp"
+
+/* Full state of the simulation: settings, tiles, nests, pheromones and ants of every colony,
+ * so a run can be resumed exactly where it was saved.
+ *
+ * File is a header, a table of sections and the sections themselves. Every section starts at a page-aligned
+ * offset, so when the file is mapped into memory every grid and array of ants is copied straight from
+ * the mapped pages, nothing is parsed but the settings. Sections may be compressed with deflate instead,
+ * in chunks which are inflated in parallel. Values are in the byte order of the machine which wrote them,
+ * files of other versions aren't loaded, the version is bumped whenever the layout changes.
+ *
+ * State is captured into buffers owned by the checkpoint, they are reused by the next capture */
+class Checkpoint
+{
+public:
+	static constexpr uint32_t k_version = 2;
+	static constexpr size_t   k_alignment = 4096;
+
+	// Tick is the amount of ticks simulated so far, it's given back by Load
+	void Capture(const Settings &settings, const World &world, const ColoniesManager &coloniesManager,
+	             uint64_t tick);
+	// Writes to a temporary file which replaces the given one, so an interrupted write leaves the old one.
+	// Compressed sections are smaller but they can't be copied straight from the file when loaded
+	bool Write(const std::string &filename, bool compress = false) const;
+
+	uint64_t GetTick() const { return m_tick; }
+	// Bytes of captured state
+	size_t GetSize() const;
+
+	/* World and colonies are replaced by the saved ones, settings by the saved settings.
+	 * Settings::Instance has to return the given settings, they are read while the world is built.
+	 * Returns an error, empty on success, nothing is changed on failure */
+	static std::string Load(const std::string &filename, Settings &settings, std::unique_ptr<World> &world,
+	                        std::unique_ptr<ColoniesManager> &coloniesManager, uint64_t &tick);
+
+	// Only reads the settings, for showing them before the checkpoint is loaded
+	static std::string LoadSettings(const std::string &filename, Settings &settings);
+
+private:
+	enum class SectionType : uint32_t
+	{
+		Settings, TileTypes, TileAmounts, Nests, PheromoneState, Pheromones, ColonyState, AntSlots, AntGenerations,
+		Ants
+	};
+
+	// Sections of colonies are told apart by colony, arrays of ants by array too
+	struct SectionKey
+	{
+		SectionType type;
+		uint16_t    colony;
+		uint16_t    array;
+
+		bool operator==(const SectionKey &other) const
+		{
+			return type == other.type && colony == other.colony && array == other.array;
+		}
+	};
+
+	enum Encoding : uint32_t
+	{
+		Raw, Deflate
+	};
+
+	struct Section
+	{
+		SectionKey           key;
+		std::vector<uint8_t> data;
+	};
+
+	struct Header;
+	struct SectionEntry;
+	class Reader;
+
+	struct NestState;
+	struct PheromoneState;
+	struct ColonyState;
+
+	// Reuses the buffer of the section with the same index in the previous capture
+	uint8_t *AddSection(SectionKey key, size_t size);
+
+	template<typename T>
+	void AddArray(SectionKey key, const std::vector<T> &values);
+
+	static std::string RestoreTiles(const Reader &reader, TileMap &tileMap);
+	static std::string RestoreNests(const Reader &reader, ColoniesManager &coloniesManager);
+	static std::string RestorePheromones(const Reader &reader, PheromoneMap &pheromoneMap);
+	static std::string RestoreColony(const Reader &reader, uint16_t index, AntColony &colony);
+
+private:
+	std::vector<Section> m_sections;
+	size_t               m_sectionsAmount = 0;
+
+	uint64_t m_tick = 0;
+};
+
+#endif //ANTS_CHECKPOINT_HPP
@@ -0,0 +1,88 @@
+#include "Checkpointer.hpp"
+
+#include <chrono>
+
+#include "Profiler.hpp"
+
+Checkpointer::Checkpointer(Callback onWritten) :
+		m_onWritten(std::move(onWritten))
+{
+	m_thread = std::thread(&Checkpointer::Run, this);
+}
+
+Checkpointer::~Checkpointer()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_stop = true;
+	}
+	m_condition.notify_one();
+	m_thread.join();
+}
+
+void Checkpointer::Save(const std::string &filename, const Settings &settings, const World &world,
+                        const ColoniesManager &coloniesManager, uint64_t tick)
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	// Buffer which isn't being written, a queued capture in it is replaced
+	int buffer;
+	{
+		std::lock_guard lock(m_mutex);
+		buffer = m_writingBuffer == 0 ? 1 : 0;
+		if ( m_queuedBuffer == buffer )
+		{
+			m_queuedBuffer = k_noBuffer;
+		}
+	}
+
+	{
+		ProfileScope profileScope(Profiler::CheckpointCapture);
+		m_buffers[buffer].Capture(settings, world, coloniesManager, tick);
+	}
+
+	m_stalls[buffer] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	{
+		std::lock_guard lock(m_mutex);
+		m_queuedBuffer   = buffer;
+		m_queuedFilename = filename;
+	}
+	m_condition.notify_one();
+}
+
+void Checkpointer::Run()
+{
+	std::unique_lock lock(m_mutex);
+	while ( true )
+	{
+		m_condition.wait(lock, [this]()
+		{
+			return m_queuedBuffer != k_noBuffer || m_stop;
+		});
+		// Queued capture is written even when stopping, it was requested before
+		if ( m_queuedBuffer == k_noBuffer )
+		{
+			return;
+		}
+
+		m_writingBuffer = m_queuedBuffer;
+		m_queuedBuffer  = k_noBuffer;
+		const std::string filename    = std::move(m_queuedFilename);
+		const Checkpoint  &checkpoint = m_buffers[m_writingBuffer];
+		const double      stall       = m_stalls[m_writingBuffer];
+		lock.unlock();
+
+		const auto start = std::chrono::steady_clock::now();
+		bool       written;
+		{
+			ProfileScope profileScope(Profiler::CheckpointWrite);
+			written = checkpoint.Write(filename, true);
+		}
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		m_onWritten(checkpoint.GetTick(), filename, written, stall, seconds);
+
+		lock.lock();
+		m_writingBuffer = k_noBuffer;
+	}
+}
@@ -0,0 +1,60 @@
+#ifndef ANTS_CHECKPOINTER_HPP
+#define ANTS_CHECKPOINTER_HPP
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Checkpoint.hpp"
+
+/* Saves checkpoints without stopping the simulation for the write: state is captured between ticks,
+ * which only copies it, then it's compressed and written by a thread of the checkpointer.
+ *
+ * Captures are double-buffered: a new one goes to the buffer which isn't being written,
+ * so the simulation never waits for a write. A capture which wasn't written yet is replaced by a newer one */
+class Checkpointer
+{
+public:
+	// Called by the writing thread after every write with milliseconds the simulation was stopped for capturing
+	// and seconds of compressing and writing
+	using Callback = std::function<void(uint64_t tick, const std::string &filename, bool written, double stall,
+	                                    double seconds)>;
+
+	explicit Checkpointer(Callback onWritten);
+	// Waits until the last capture is written
+	~Checkpointer();
+
+	Checkpointer(const Checkpointer &) = delete;
+	Checkpointer &operator=(const Checkpointer &) = delete;
+
+	// Called between ticks, time of capturing is recorded by the profiler too
+	void Save(const std::string &filename, const Settings &settings, const World &world,
+	          const ColoniesManager &coloniesManager, uint64_t tick);
+
+private:
+	static constexpr int k_noBuffer = -1;
+
+	void Run();
+
+private:
+	Callback m_onWritten;
+
+	std::array<Checkpoint, 2> m_buffers;
+	// Milliseconds of capturing, per buffer
+	std::array<double, 2>     m_stalls{};
+
+	std::mutex              m_mutex;
+	std::condition_variable m_condition;
+	int                     m_writingBuffer = k_noBuffer;
+	int                     m_queuedBuffer  = k_noBuffer;
+	std::string             m_queuedFilename;
+	bool                    m_stop          = false;
+
+	std::thread m_thread;
+};
+
+#endif //ANTS_CHECKPOINTER_HPP
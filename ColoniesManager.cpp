@@ -1,7 +1,15 @@
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <tuple>
 #include "ColoniesManager.hpp"
 #include "Settings.hpp"
 #include "Random.hpp"
+#include "Profiler.hpp"
+
+// Throughput is averaged over at least this many seconds
+constexpr double k_throughputWindow = 0.5;
 
 IntVec2 GetRandomNestPos(int nestSize, int width, int height)
 {
@@ -13,8 +21,13 @@ ColoniesManager::ColoniesManager(TileMap &tileMap)
 //	assert(s_instance);
 //	s_instance = this;
 
-	m_colonies.resize(k_maxColoniesAmount);
-	m_nests.resize(k_maxNestsAmount);
+	const size_t coloniesAmount = std::clamp<size_t>(Settings::Instance().GetAntColonySettings().coloniesAmount, 1,
+	                                                 k_maxColoniesAmount);
+	// Every colony gets its own nest
+	const size_t nestsAmount    = coloniesAmount;
+
+	m_colonies.resize(coloniesAmount);
+	m_nests.resize(nestsAmount);
 
 	auto &globalSettings = Settings::Instance().GetGlobalSettings();
 	int  width           = static_cast<int>(globalSettings.mapWidth);
@@ -22,13 +35,25 @@ ColoniesManager::ColoniesManager(TileMap &tileMap)
 
 	std::cout << "Colony manager map size: " << width << "x" << height << std::endl;
 
+	m_pheromoneMap = std::make_unique<PheromoneMap>(width, height, coloniesAmount,
+	                                                Settings::Instance().GetPheromoneMapSettings().pheromoneEvaporationRate);
+
 	int nestSize = Settings::Instance().GetAntColonySettings().nestSize;
 
 	std::cout << "Creating colonies";
-	for ( size_t i = 0; i < k_maxNestsAmount; ++i )
+	for ( size_t i = 0; i < coloniesAmount; ++i )
 	{
 //		IntVec2 nestPos = GetRandomNestPos(nestSize, width, height);
+		// First nest is in the center, others are spread evenly around it
 		IntVec2 nestPos = {width / 2, height / 2};
+		if ( i > 0 )
+		{
+			const float angle  = 2.f * static_cast<float>(M_PI) * static_cast<float>(i - 1) /
+			                     static_cast<float>(coloniesAmount - 1);
+			const float radius = static_cast<float>(std::min(width, height)) / 4.f;
+			nestPos.x += static_cast<int>(radius * std::cos(angle));
+			nestPos.y += static_cast<int>(radius * std::sin(angle));
+		}
 		Vector2 np; np.x = nestPos.x; np.y = nestPos.y;
 		CreateColony(np);//globalSettings.WorldToScreen(nestPos));
 		CreateNest(nestPos, tileMap, m_colonies[i].get());
@@ -37,7 +62,7 @@ ColoniesManager::ColoniesManager(TileMap &tileMap)
 	std::cout << "\nColonies created." << std::endl;
 
 	std::cout << "Creating empty nests";
-	for ( size_t i = s_nextNestId; i < k_maxNestsAmount; ++i )
+	for ( size_t i = s_nextNestId; i < nestsAmount; ++i )
 	{
 		IntVec2 nestPos = GetRandomNestPos(nestSize, width, height);
 		CreateNest(nestPos, tileMap, nullptr);
@@ -48,18 +73,18 @@ ColoniesManager::ColoniesManager(TileMap &tileMap)
 
 void ColoniesManager::CreateColony(const Vector2 &pos)
 {
-	if ( s_nextColonyId >= k_maxColoniesAmount )
+	if ( s_nextColonyId >= m_colonies.size())
 	{
 		return;
 	}
 
-	m_colonies[s_nextColonyId] = std::make_unique<AntColony>(s_nextColonyId, pos);
+	m_colonies[s_nextColonyId] = std::make_unique<AntColony>(s_nextColonyId, pos, *m_pheromoneMap);
 	++s_nextColonyId;
 }
 
 void ColoniesManager::CreateNest(const IntVec2 &pos, TileMap &tileMap, AntColony *colony)
 {
-	if ( s_nextNestId >= k_maxNestsAmount )
+	if ( s_nextNestId >= m_nests.size())
 	{
 		return;
 	}
@@ -67,3 +92,143 @@ void ColoniesManager::CreateNest(const IntVec2 &pos, TileMap &tileMap, AntColony
 	m_nests[s_nextNestId] = std::make_unique<Nest>(s_nextColonyId, colony, pos, tileMap);
 	++s_nextNestId;
 }
+
+void ColoniesManager::Update(TileMap &tileMap)
+{
+	ProfileScope profileScope(Profiler::Tick);
+
+	const auto updateStart = std::chrono::steady_clock::now();
+
+	for ( auto &colony: m_colonies )
+	{
+		colony->BeginTick();
+	}
+
+	// Colonies are tasks of one parallel region, their batches of ants are tasks too,
+	// so threads don't wait on barriers between colonies.
+	// Ants of all colonies read the shared pheromones, so evaporation due since the last tick
+	// is finished first, its taskloop waits for its rows before colonies are started
+	{
+		ProfileScope antsUpdateScope(Profiler::AntsUpdate);
+#pragma omp parallel default(none) shared(m_colonies, m_pheromoneMap, tileMap)
+#pragma omp single
+		{
+			{
+				ProfileScope evaporationScope(Profiler::Evaporation);
+				m_pheromoneMap->ApplyEvaporation();
+			}
+			for ( auto &colony: m_colonies )
+			{
+				AntColony *antColony = colony.get();
+#pragma omp task default(none) firstprivate(antColony) shared(tileMap)
+				antColony->UpdateAnts(tileMap);
+			}
+		}
+	}
+
+	{
+		ProfileScope foodScope(Profiler::Food);
+		// Nests spawn new ants, so food is stored serially
+		for ( auto &colony: m_colonies )
+		{
+			colony->StoreFood(tileMap);
+		}
+
+#pragma omp parallel default(none) shared(m_colonies, tileMap)
+#pragma omp single
+		for ( auto &colony: m_colonies )
+		{
+			AntColony *antColony = colony.get();
+#pragma omp task default(none) firstprivate(antColony) shared(tileMap)
+			antColony->TakeFood(tileMap);
+		}
+
+		ResolveContestedFood(tileMap);
+		tileMap.ApplyDepletions();
+	}
+
+	// Deposits of all colonies are applied together, next to sorting of ants
+	{
+		ProfileScope postUpdateScope(Profiler::PostUpdate);
+#pragma omp parallel default(none) shared(m_colonies, m_pheromoneMap)
+#pragma omp single
+		{
+			for ( auto &colony: m_colonies )
+			{
+				AntColony *antColony = colony.get();
+#pragma omp task default(none) firstprivate(antColony)
+				antColony->EndTick();
+			}
+			m_pheromoneMap->ApplyDeposits();
+		}
+	}
+
+	m_pheromoneMap->Update();
+
+	size_t antsAmount = 0;
+	for ( auto &colony: m_colonies )
+	{
+		colony->FinishTick();
+		antsAmount += colony->GetAntsAmount();
+	}
+
+	m_measuredAntUpdates += antsAmount;
+	m_measuredSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - updateStart).count();
+	if ( m_measuredSeconds >= k_throughputWindow )
+	{
+		m_antUpdatesPerSecond = static_cast<double>(m_measuredAntUpdates) / m_measuredSeconds;
+		m_measuredAntUpdates  = 0;
+		m_measuredSeconds     = 0;
+	}
+}
+
+void ColoniesManager::ResolveContestedFood(const TileMap &tileMap)
+{
+	m_contestedClaims.clear();
+	for ( auto &colony: m_colonies )
+	{
+		const auto &takenFoodPos = colony->GetAnts().takenFoodPos;
+		for ( size_t index: colony->GatherContestedAnts())
+		{
+			m_contestedClaims.push_back({takenFoodPos[index], colony->GetId(), index});
+		}
+	}
+
+	if ( m_contestedClaims.empty())
+	{
+		return;
+	}
+
+	// Groups claims by tile, claims are served in the same order regardless of threads scheduling
+	const auto claimOrder = [](const FoodClaim &claim)
+	{
+		return std::make_tuple(claim.pos.y, claim.pos.x, claim.colonyId, claim.index);
+	};
+	std::sort(m_contestedClaims.begin(), m_contestedClaims.end(), [&claimOrder](const FoodClaim &a, const FoodClaim &b)
+	{
+		return claimOrder(a) < claimOrder(b);
+	});
+
+	for ( size_t groupBegin = 0; groupBegin < m_contestedClaims.size(); )
+	{
+		const IntVec2 &pos     = m_contestedClaims[groupBegin].pos;
+		size_t        groupEnd = groupBegin;
+		while ( groupEnd < m_contestedClaims.size() && m_contestedClaims[groupEnd].pos.x == pos.x &&
+		        m_contestedClaims[groupEnd].pos.y == pos.y )
+		{
+			++groupEnd;
+		}
+
+		// Amount left is negative, tile had as much food as claims minus the overdraft
+		const int  amountLeft   = tileMap.GetFoodAmount(pos);
+		const int  claimsAmount = static_cast<int>(groupEnd - groupBegin);
+		const auto foodAmount   = static_cast<size_t>(std::max(claimsAmount + amountLeft, 0));
+		for ( size_t j = groupBegin; j < groupEnd; ++j )
+		{
+			const FoodClaim &claim = m_contestedClaims[j];
+			m_colonies[claim.colonyId]->SettleContestedFood(claim.index, j - groupBegin < foodAmount);
+		}
+
+		groupBegin = groupEnd;
+	}
+}
@@ -8,20 +8,52 @@
 
 class ColoniesManager
 {
-	const size_t k_maxColoniesAmount = 1;
-	const size_t k_maxNestsAmount    = 1;
+	const size_t k_maxColoniesAmount = 16;
 public:
 	ColoniesManager(TileMap &tileMap);
 
+	// Ticks all colonies together, ant work of every colony shares the same parallel regions
+	void Update(TileMap &tileMap);
+
 	void CreateColony(const Vector2 &pos);
 	void CreateNest(const IntVec2 &pos, TileMap &tileMap, AntColony *colony);
 
 	std::vector<std::unique_ptr<AntColony>> &GetColonies() { return m_colonies; }
+	const std::vector<std::unique_ptr<AntColony>> &GetColonies() const { return m_colonies; }
+
+	const std::vector<std::unique_ptr<Nest>> &GetNests() const { return m_nests; }
+
+	PheromoneMap &GetPheromoneMap() { return *m_pheromoneMap; }
+	const PheromoneMap &GetPheromoneMap() const { return *m_pheromoneMap; }
+
+	// Measured throughput of Update, amount of ants of all colonies times ticks per second of updating
+	double GetAntUpdatesPerSecond() const { return m_antUpdatesPerSecond; }
+
+private:
+	// Settles food of ants which claimed more food than the tile had. Ants of different colonies
+	// may claim the same tile, so claims are served by colony id and then by ant index
+	void ResolveContestedFood(const TileMap &tileMap);
 
 private:
+	struct FoodClaim
+	{
+		IntVec2     pos;
+		AntColonyId colonyId;
+		size_t      index;
+	};
+
+	// Shared by all colonies, so it's created before them
+	std::unique_ptr<PheromoneMap> m_pheromoneMap;
+
 	std::vector<std::unique_ptr<AntColony>> m_colonies;
 	std::vector<std::unique_ptr<Nest>>      m_nests;
 
+	std::vector<FoodClaim> m_contestedClaims;
+
+	size_t m_measuredAntUpdates  = 0;
+	double m_measuredSeconds     = 0;
+	double m_antUpdatesPerSecond = 0;
+
 	AntColonyId s_nextColonyId = 0;
 	NestId      s_nextNestId   = 0;
 };
@@ -5,34 +5,16 @@
 ColorMap::ColorMap(size_t width, size_t height, const Color &defaultColor)
 		:
 		m_width(static_cast<int>(width)), m_height(static_cast<int>(height)),
-		m_size(m_width * m_height), m_defaultColor(defaultColor)
+		m_size(m_width * m_height), m_defaultColor(defaultColor),
+		m_colors(m_size, defaultColor)
 {
 //	m_screenToMapRatio = Settings::Instance().GetGlobalSettings().screenToMapRatio;
-
-	m_drawSrc  = {0, 0,
-	              static_cast<float>(m_width),
-	              static_cast<float>(m_height)};
-	m_drawDest = {0, 0,
-	              static_cast<float>(m_width), //* m_screenToMapRatio,
-	              static_cast<float>(m_height)}; //* m_screenToMapRatio};
-
-	Image image = GenImageColor(m_width, m_height, defaultColor);
-
-	m_texture = LoadTextureFromImage(image);
-	m_colors  = LoadImageColors(image);
-
-	UnloadImage(image);
-}
-
-ColorMap::~ColorMap()
-{
-	UnloadImageColors(m_colors);
-	UnloadTexture(m_texture);
+	m_changes.AddRows(0, m_height);
 }
 
 void ColorMap::Update()
 {
-	UpdateTexture(m_texture, m_colors);
+	m_changes.AddRows(0, m_height);
 }
 
 void ColorMap::Clear()
@@ -45,7 +27,12 @@ void ColorMap::Clear()
 
 void ColorMap::UpdatePixel(int x, int y)
 {
-	UpdateTextureRec(m_texture, {static_cast<float>(x), static_cast<float>(y), 1, 1}, &m_colors[y * m_width + x]);
+	if ( !IsInBounds(x, y, 0, m_width, 0, m_height))
+	{
+		return;
+	}
+
+	m_changes.AddPixel(x, y);
 }
 
 void ColorMap::Add(int n, const Color &color)
@@ -81,7 +68,54 @@ Color &ColorMap::GetMutable(int n)
 	return m_colors[n];
 }
 
-void ColorMap::Draw() const
+void ColorMap::Changes::AddPixel(int x, int y)
+{
+	if ( y >= rows.begin && y < rows.end )
+	{
+		return;
+	}
+
+	if ( pixels.size() < k_maxPixels )
+	{
+		if ( pixels.capacity() < k_maxPixels )
+		{
+			pixels.reserve(k_maxPixels);
+		}
+		pixels.push_back({x, y});
+		return;
+	}
+
+	AddRows(y, y + 1);
+}
+
+void ColorMap::Changes::AddRows(int begin, int end)
+{
+	if ( begin >= end )
+	{
+		return;
+	}
+
+	if ( rows.IsEmpty())
+	{
+		rows = {begin, end};
+		return;
+	}
+
+	rows.begin = std::min(rows.begin, begin);
+	rows.end   = std::max(rows.end, end);
+}
+
+void ColorMap::Changes::Merge(const Changes &other)
+{
+	AddRows(other.rows.begin, other.rows.end);
+	for ( const auto &pixel: other.pixels )
+	{
+		AddPixel(pixel.x, pixel.y);
+	}
+}
+
+void ColorMap::Changes::Clear()
 {
-	DrawTexturePro(m_texture, m_drawSrc, m_drawDest, {0, 0}, 0, WHITE);
+	pixels.clear();
+	rows = {0, 0};
 }
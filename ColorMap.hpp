@@ -3,15 +3,45 @@
 
 #include <raylib.h>
 #include <cstdint>
+#include <vector>
 
 #include "IntVec.hpp"
 
+/* Colors of every cell of a map, kept in memory only. Changes are collected as a few single pixels
+ * and a range of dirty rows, renderer uploads only them, so the simulation never touches the GPU.
+ * Only plain raylib types are used here, nothing from raylib has to be linked */
 class ColorMap
 {
+public:
+	// Rows [begin, end) were changed
+	struct DirtyRows
+	{
+		int begin, end;
+
+		bool IsEmpty() const { return begin >= end; }
+	};
+
+	// Pixels changed one by one, once there are too many of them their rows are marked instead,
+	// so changes never take more than a few bytes and merging them never allocates
+	struct Changes
+	{
+		static constexpr size_t k_maxPixels = 64;
+
+		std::vector<IntVec2> pixels;
+		DirtyRows            rows = {0, 0};
+
+		void AddPixel(int x, int y);
+		void AddRows(int begin, int end);
+		void Merge(const Changes &other);
+		void Clear();
+
+		bool IsEmpty() const { return pixels.empty() && rows.IsEmpty(); }
+	};
+
 public:
 	ColorMap(size_t width, size_t height, const Color &defaultColor);
-	~ColorMap();
 
+	// Marks the whole map as changed
 	void Update();
 
 	void Clear();
@@ -29,12 +59,16 @@ public:
 
 	inline void UnsafeSet(int x, int y, const Color &color) { m_colors[y * m_width + x] = color; };
 
+	const Color *GetColors() const { return m_colors.data(); }
+
+	// Changes since the last ClearChanges
+	const Changes &GetChanges() const { return m_changes; }
+	void ClearChanges() { m_changes.Clear(); }
+
 	Color &GetMutable(int n);
 	inline Color &GetMutable(int x, int y);
 	inline Color &GetMutable(const IntVec2 &pos);
 
-	void Draw() const;
-
 	int GetWidth() const { return m_width; }
 	int GetHeight() const { return m_height; }
 
@@ -47,10 +81,9 @@ private:
 	Color m_defaultColor;
 	Color m_errorColor = BLACK;
 
-	Texture m_texture;
-	Color   *m_colors;
+	std::vector<Color> m_colors;
 
-	Rectangle m_drawSrc, m_drawDest;
+	Changes m_changes;
 };
 
 inline void ColorMap::UpdatePixel(const IntVec2 &pos)
@@ -0,0 +1,67 @@
+#include "ColorMapTexture.hpp"
+
+ColorMapTexture::~ColorMapTexture()
+{
+	Unload();
+}
+
+void ColorMapTexture::Sync(const RenderSnapshot::Layer &layer)
+{
+	if ( layer.IsEmpty())
+	{
+		return;
+	}
+
+	if ( !m_loaded || m_texture.width != layer.width || m_texture.height != layer.height )
+	{
+		Unload();
+
+		Image image{};
+		image.data    = const_cast<Color *>(layer.colors.data());
+		image.width   = layer.width;
+		image.height  = layer.height;
+		image.mipmaps = 1;
+		image.format  = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+
+		m_texture = LoadTextureFromImage(image);
+		m_loaded  = true;
+		return;
+	}
+
+	const Color *colors = layer.colors.data();
+	for ( const auto &pixel: layer.changes.pixels )
+	{
+		UpdateTextureRec(m_texture, {static_cast<float>(pixel.x), static_cast<float>(pixel.y), 1, 1},
+		                 colors + static_cast<size_t>(pixel.y) * layer.width + pixel.x);
+	}
+
+	// Rows are contiguous in memory, so the dirty range is uploaded at once
+	const ColorMap::DirtyRows &rows = layer.changes.rows;
+	if ( !rows.IsEmpty())
+	{
+		UpdateTextureRec(m_texture,
+		                 {0, static_cast<float>(rows.begin),
+		                  static_cast<float>(layer.width), static_cast<float>(rows.end - rows.begin)},
+		                 colors + static_cast<size_t>(rows.begin) * layer.width);
+	}
+}
+
+void ColorMapTexture::Draw() const
+{
+	if ( !m_loaded )
+	{
+		return;
+	}
+
+	const Rectangle rectangle = {0, 0, static_cast<float>(m_texture.width), static_cast<float>(m_texture.height)};
+	DrawTexturePro(m_texture, rectangle, rectangle, {0, 0}, 0, WHITE);
+}
+
+void ColorMapTexture::Unload()
+{
+	if ( m_loaded )
+	{
+		UnloadTexture(m_texture);
+		m_loaded = false;
+	}
+}
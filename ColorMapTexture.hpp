@@ -0,0 +1,32 @@
+#ifndef ANTS_COLORMAPTEXTURE_HPP
+#define ANTS_COLORMAPTEXTURE_HPP
+
+#include <raylib.h>
+
+#include "RenderSnapshot.hpp"
+
+// Texture of a ColorMap, from every snapshot only its changed pixels and rows are uploaded
+class ColorMapTexture
+{
+public:
+	ColorMapTexture() = default;
+	~ColorMapTexture();
+
+	ColorMapTexture(const ColorMapTexture &) = delete;
+	ColorMapTexture &operator=(const ColorMapTexture &) = delete;
+
+	// Has to be called once for every snapshot, in order.
+	// Texture is recreated when size of the map changes, e.g. after the world was reset
+	void Sync(const RenderSnapshot::Layer &layer);
+
+	void Draw() const;
+
+private:
+	void Unload();
+
+private:
+	Texture m_texture{};
+	bool    m_loaded = false;
+};
+
+#endif //ANTS_COLORMAPTEXTURE_HPP
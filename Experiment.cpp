@@ -0,0 +1,161 @@
+#include "Experiment.hpp"
+
+#include <chrono>
+
+#include "Random.hpp"
+#include "Checkpoint.hpp"
+
+Experiment::Experiment(Settings &settings, const Map *map)
+{
+	Random::Seed(static_cast<uint32_t>(settings.GetWorldGenerationSettings().seed));
+
+	if ( map )
+	{
+		settings.GetGlobalSettings().mapWidth  = map->width;
+		settings.GetGlobalSettings().mapHeight = map->height;
+	}
+
+	m_world = std::make_unique<World>(map == nullptr);
+	if ( map )
+	{
+		m_world->LoadWorldFromColors(settings, map->colors.data(), map->width, map->height);
+	}
+
+	Random::Seed(Random::Mix(static_cast<uint32_t>(settings.GetWorldGenerationSettings().seed)));
+	m_coloniesManager = std::make_unique<ColoniesManager>(m_world->GetTileMap());
+}
+
+Experiment::Experiment(std::unique_ptr<World> world, std::unique_ptr<ColoniesManager> coloniesManager, long tick) :
+		m_world(std::move(world)), m_coloniesManager(std::move(coloniesManager)), m_tick(tick)
+{
+}
+
+Experiment::Map Experiment::GenerateMap(const Settings &settings)
+{
+	Random::Seed(static_cast<uint32_t>(settings.GetWorldGenerationSettings().seed));
+
+	const World   world;
+	const TileMap &tileMap = world.GetTileMap();
+
+	Map map;
+	map.width  = tileMap.GetWidth();
+	map.height = tileMap.GetHeight();
+	map.colors.reserve(static_cast<size_t>(map.width) * map.height);
+	for ( int y = 0; y < map.height; ++y )
+	{
+		for ( int x = 0; x < map.width; ++x )
+		{
+			switch ( tileMap.GetTile({x, y}).GetType())
+			{
+				case TileType::eFood:
+					map.colors.push_back({0, 255, 0, 255});
+					break;
+				case TileType::eWall:
+					map.colors.push_back({255, 255, 255, 255});
+					break;
+				default:
+					map.colors.push_back({0, 0, 0, 255});
+					break;
+			}
+		}
+	}
+
+	return map;
+}
+
+void Experiment::Run(long ticks, long interval, const std::function<void(const Metrics &)> &onMetrics)
+{
+	using Clock = std::chrono::steady_clock;
+
+	double intervalSeconds = 0;
+	long   intervalTicks   = 0;
+	for ( long tick = 1; tick <= ticks; ++tick )
+	{
+		const auto start = Clock::now();
+		m_coloniesManager->Update(m_world->GetTileMap());
+		intervalSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+		++intervalTicks;
+		++m_tick;
+
+		if ( tick % interval == 0 || tick == ticks )
+		{
+			onMetrics(Measure(m_tick, intervalSeconds * 1000.0 / static_cast<double>(intervalTicks)));
+			intervalSeconds = 0;
+			intervalTicks   = 0;
+		}
+	}
+}
+
+bool Experiment::SaveCheckpoint(const std::string &filename, const Settings &settings) const
+{
+	Checkpoint checkpoint;
+	checkpoint.Capture(settings, *m_world, *m_coloniesManager, static_cast<uint64_t>(m_tick));
+	return checkpoint.Write(filename);
+}
+
+void Experiment::WriteCsvHeader(std::ostream &stream, size_t coloniesAmount)
+{
+	stream << "tick,tick_ms,food_remaining";
+	for ( size_t colony = 0; colony < coloniesAmount; ++colony )
+	{
+		stream << ",ants_" << colony << ",food_delivered_" << colony;
+	}
+	stream << '\n';
+}
+
+void Experiment::WriteCsvRow(std::ostream &stream, const Metrics &metrics)
+{
+	stream << metrics.tick << ',' << metrics.tickMilliseconds << ',' << metrics.foodRemaining;
+	for ( size_t colony = 0; colony < metrics.ants.size(); ++colony )
+	{
+		stream << ',' << metrics.ants[colony] << ',' << metrics.foodDelivered[colony];
+	}
+	stream << '\n';
+}
+
+Experiment::Metrics Experiment::Measure(long tick, double tickMilliseconds) const
+{
+	Metrics metrics;
+	metrics.tick             = tick;
+	metrics.tickMilliseconds = tickMilliseconds;
+
+	const TileMap &tileMap = m_world->GetTileMap();
+	for ( int y = 0; y < tileMap.GetHeight(); ++y )
+	{
+		for ( int x = 0; x < tileMap.GetWidth(); ++x )
+		{
+			const Tile &tile = tileMap.GetTile({x, y});
+			if ( tile.GetType() == TileType::eFood )
+			{
+				metrics.foodRemaining += tile.GetAmount();
+			}
+		}
+	}
+
+	const auto &colonies = m_coloniesManager->GetColonies();
+	metrics.ants.resize(colonies.size());
+	metrics.foodDelivered.assign(colonies.size(), 0);
+	for ( size_t colony = 0; colony < colonies.size(); ++colony )
+	{
+		metrics.ants[colony] = colonies[colony]->GetAntsAmount();
+	}
+
+	// Colony of a nest is found by its id, nests may be created in any order
+	for ( const auto &nest: m_coloniesManager->GetNests())
+	{
+		const AntColony *colony = nest->GetColony();
+		if ( colony == nullptr )
+		{
+			continue;
+		}
+		for ( size_t i = 0; i < colonies.size(); ++i )
+		{
+			if ( colonies[i]->GetId() == colony->GetId())
+			{
+				metrics.foodDelivered[i] += nest->GetFoodDelivered();
+			}
+		}
+	}
+
+	return metrics;
+}
@@ -0,0 +1,73 @@
+#ifndef ANTS_EXPERIMENT_HPP
+#define ANTS_EXPERIMENT_HPP
+
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "World.hpp"
+#include "ColoniesManager.hpp"
+#include "Settings.hpp"
+
+/* Headless run of the simulation for a fixed amount of ticks at full speed, for batch runs.
+ * Generator of worlds and nests is seeded by the seed of settings, so runs with the same settings repeat.
+ * Nests are placed the same way whether the world is generated or built from a map.
+ * Settings::Instance is read by the simulation, so it has to return the settings the experiment was created with */
+class Experiment
+{
+public:
+	// Colors of an image the world is built from, see World::LoadWorldFromColors
+	struct Map
+	{
+		std::vector<Color> colors;
+		int                width  = 0;
+		int                height = 0;
+	};
+
+	struct Metrics
+	{
+		long   tick = 0;
+		// Average over the ticks since the previous metrics
+		double tickMilliseconds = 0;
+		long   foodRemaining    = 0;
+
+		// Per colony, food is counted since the start
+		std::vector<size_t> ants;
+		std::vector<long>   foodDelivered;
+	};
+
+	// World is generated unless a map is given, map size of settings is taken from the map then
+	explicit Experiment(Settings &settings, const Map *map = nullptr);
+	// Continues a run restored by Checkpoint::Load, tick is the amount of ticks simulated before
+	Experiment(std::unique_ptr<World> world, std::unique_ptr<ColoniesManager> coloniesManager, long tick);
+
+	// Generates the world the experiment would generate and takes colors of its tiles,
+	// so experiments which differ only in settings of ants can share it
+	static Map GenerateMap(const Settings &settings);
+
+	// Runs for the given amount of ticks more. Metrics are reported every interval ticks and after the last tick,
+	// ticks of metrics are counted from the start of the experiment
+	void Run(long ticks, long interval, const std::function<void(const Metrics &)> &onMetrics);
+
+	// Settings have to be the ones the experiment runs with
+	bool SaveCheckpoint(const std::string &filename, const Settings &settings) const;
+
+	// Columns of colonies are repeated for every colony
+	static void WriteCsvHeader(std::ostream &stream, size_t coloniesAmount);
+	static void WriteCsvRow(std::ostream &stream, const Metrics &metrics);
+
+	size_t GetColoniesAmount() const { return m_coloniesManager->GetColonies().size(); }
+
+private:
+	Metrics Measure(long tick, double tickMilliseconds) const;
+
+private:
+	std::unique_ptr<World>           m_world;
+	std::unique_ptr<ColoniesManager> m_coloniesManager;
+
+	long m_tick = 0;
+};
+
+#endif //ANTS_EXPERIMENT_HPP
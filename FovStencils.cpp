@@ -0,0 +1,57 @@
+#include "FovStencils.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+void FovStencils::Build(int range)
+{
+	range = std::clamp(range, 0, 127);
+	if ( range == m_range )
+	{
+		return;
+	}
+	m_range = range;
+
+	m_cells.clear();
+	m_offsets.assign(k_headingsAmount + 1, 0);
+
+	std::vector<Cell> rangeCells;
+	for ( int heading = 0; heading < k_headingsAmount; ++heading )
+	{
+		const size_t headingBegin = m_cells.size();
+		const auto   rotation     = static_cast<Angle>(heading << ( 16 - k_headingBits ));
+
+		for ( int j = 1; j <= range; ++j )
+		{
+			rangeCells.clear();
+			// Forward goes first, so it gets cells shared with sides
+			for ( int side: {0, -1, 1} )
+			{
+				const auto sideRotation = static_cast<Angle>(rotation + side * BinaryAngle::k_eighthTurn);
+				const Cell cell{static_cast<int8_t>(std::lround(BinaryAngle::Cos(sideRotation) * j)),
+				                static_cast<int8_t>(std::lround(BinaryAngle::Sin(sideRotation) * j)),
+				                static_cast<int8_t>(side), static_cast<uint8_t>(j)};
+
+				const auto isSameCell = [&cell](const Cell &other)
+				{
+					return other.dx == cell.dx && other.dy == cell.dy;
+				};
+				if ( std::none_of(m_cells.begin() + headingBegin, m_cells.end(), isSameCell) &&
+				     std::none_of(rangeCells.begin(), rangeCells.end(), isSameCell))
+				{
+					rangeCells.push_back(cell);
+				}
+			}
+
+			// Sensing walks left to right, as ants did before stencils
+			std::sort(rangeCells.begin(), rangeCells.end(), [](const Cell &a, const Cell &b)
+			{
+				return a.side < b.side;
+			});
+			m_cells.insert(m_cells.end(), rangeCells.begin(), rangeCells.end());
+		}
+
+		m_offsets[heading + 1] = static_cast<uint32_t>(m_cells.size());
+	}
+	m_cells.shrink_to_fit();
+}
@@ -0,0 +1,58 @@
+#ifndef ANTS_FOVSTENCILS_HPP
+#define ANTS_FOVSTENCILS_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "BinaryAngle.hpp"
+
+/* Cells an ant sees for every quantized heading, relative to the cell the ant stands on.
+ * Ant looks along three directions: left (-45 deg), forward and right (+45 deg),
+ * cells are ordered by range and then by side, every cell appears only once,
+ * cells shared by several directions at the same range belong to the forward one. */
+class FovStencils
+{
+public:
+	static constexpr int k_headingBits    = 8;
+	static constexpr int k_headingsAmount = 1 << k_headingBits;
+
+	struct Cell
+	{
+		int8_t dx, dy;
+		// -1 left; 0 forward; 1 right
+		int8_t side;
+		uint8_t range;
+	};
+
+	struct Stencil
+	{
+		const Cell *begin;
+		const Cell *end;
+	};
+
+	explicit FovStencils(int range = 0) { Build(range); }
+
+	void Build(int range);
+
+	static int QuantizeHeading(Angle rotation)
+	{
+		return (( rotation + ( 1 << ( 15 - k_headingBits ))) >> ( 16 - k_headingBits )) & ( k_headingsAmount - 1 );
+	}
+
+	Stencil Get(int heading) const
+	{
+		return {m_cells.data() + m_offsets[heading], m_cells.data() + m_offsets[heading + 1]};
+	}
+	Stencil Get(Angle rotation) const { return Get(QuantizeHeading(rotation)); }
+
+	int GetRange() const { return m_range; }
+
+private:
+	int m_range = -1;
+
+	std::vector<Cell>     m_cells;
+	// Stencil of heading h is [m_offsets[h], m_offsets[h + 1])
+	std::vector<uint32_t> m_offsets;
+};
+
+#endif //ANTS_FOVSTENCILS_HPP
@@ -0,0 +1,241 @@
+// Runs seeded scenarios and checks hashes of their final state against stored goldens.
+// Every scenario is run with 1 thread and the scalar reference implementations,
+// then with N threads and the best implementations, both runs have to give the same state.
+// Usage: Ants-golden [goldens.json] [-t threads] [--record]
+// Exits with 1 when a hash differs, with 2 on bad input.
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <omp.h>
+
+#include "Settings.hpp"
+#include "World.hpp"
+#include "ColoniesManager.hpp"
+#include "StateHash.hpp"
+#include "AntsMovement.hpp"
+#include "Random.hpp"
+
+using json = nlohmann::json;
+
+constexpr int k_seed = 1;
+
+struct Scenario
+{
+	std::string name;
+	int         ticks;
+	// Changes defaults of the settings, seed is already set
+	std::function<void(Settings &)> setup;
+};
+
+std::vector<Scenario> CreateScenarios()
+{
+	return {
+			{"single-colony", 1000, [](Settings &settings)
+			{
+				settings.GetGlobalSettings().mapWidth           = 256;
+				settings.GetGlobalSettings().mapHeight          = 256;
+				settings.GetAntColonySettings().antsStartAmount = 1000;
+				settings.GetAntColonySettings().antsMaxAmount   = 1000;
+			}},
+			{"dynamic-life", 1000, [](Settings &settings)
+			{
+				settings.GetGlobalSettings().mapWidth           = 256;
+				settings.GetGlobalSettings().mapHeight          = 256;
+				settings.GetAntColonySettings().antsStartAmount = 2000;
+				settings.GetAntColonySettings().antsMaxAmount   = 5000;
+				settings.GetAntColonySettings().dynamicLife     = true;
+				settings.GetAntColonySettings().antDeathDelay   = 2;
+				settings.GetAntColonySettings().foodToSpawnAnt  = 1;
+			}},
+			{"extinction", 200, [](Settings &settings)
+			{
+				settings.GetGlobalSettings().mapWidth           = 256;
+				settings.GetGlobalSettings().mapHeight          = 256;
+				settings.GetAntColonySettings().antsStartAmount = 5;
+				settings.GetAntColonySettings().antsMaxAmount   = 5;
+				settings.GetAntColonySettings().dynamicLife     = true;
+				settings.GetAntColonySettings().antDeathDelay   = 1;
+				settings.GetAntColonySettings().foodToSpawnAnt  = 1000;
+			}},
+			{"colonies", 500, [](Settings &settings)
+			{
+				settings.GetGlobalSettings().mapWidth           = 512;
+				settings.GetGlobalSettings().mapHeight          = 512;
+				settings.GetAntColonySettings().coloniesAmount  = 8;
+				settings.GetAntColonySettings().antsStartAmount = 1000;
+				settings.GetAntColonySettings().antsMaxAmount   = 2500;
+			}},
+			{"large-population", 100, [](Settings &settings)
+			{
+				settings.GetGlobalSettings().mapWidth           = 1024;
+				settings.GetGlobalSettings().mapHeight          = 1024;
+				settings.GetAntColonySettings().antsStartAmount = 100000;
+				settings.GetAntColonySettings().antsMaxAmount   = 100000;
+				settings.GetAntColonySettings().largePopulation = true;
+			}},
+	};
+}
+
+StateHash Run(Settings &settings, const Scenario &scenario, int threads, AntsMovement::Implementation implementation)
+{
+	settings.Reset();
+	settings.GetWorldGenerationSettings().seed = k_seed;
+	scenario.setup(settings);
+
+	omp_set_num_threads(threads);
+	AntsMovement::SetImplementation(implementation);
+	Random::Seed(k_seed);
+
+	World           world;
+	ColoniesManager coloniesManager(world.GetTileMap());
+	for ( int tick = 0; tick < scenario.ticks; ++tick )
+	{
+		coloniesManager.Update(world.GetTileMap());
+	}
+
+	return StateHash::Compute(world.GetTileMap(), coloniesManager);
+}
+
+std::string ToHex(uint64_t value)
+{
+	char buffer[17];
+	std::snprintf(buffer, sizeof(buffer), "%016" PRIx64, value);
+	return buffer;
+}
+
+json ToJson(const StateHash &hash)
+{
+	return {{"ants",       ToHex(hash.ants)},
+	        {"tiles",      ToHex(hash.tiles)},
+	        {"pheromones", ToHex(hash.pheromones)}};
+}
+
+void PrintHash(const char *label, const StateHash &hash)
+{
+	std::printf("  %-10s ants %016" PRIx64 " tiles %016" PRIx64 " pheromones %016" PRIx64 "\n", label,
+	            hash.ants, hash.tiles, hash.pheromones);
+}
+
+int main(int argc, char **argv)
+{
+	std::string goldensFile = "Goldens/goldens.json";
+	int         threads     = std::max(omp_get_num_procs(), 2);
+	bool        record      = false;
+	for ( int i = 1; i < argc; ++i )
+	{
+		if ( std::strcmp(argv[i], "--record") == 0 )
+		{
+			record = true;
+		}
+		else if ( std::strcmp(argv[i], "-t") == 0 && i + 1 < argc )
+		{
+			threads = std::max(std::atoi(argv[++i]), 1);
+		}
+		else if ( argv[i][0] != '-' )
+		{
+			goldensFile = argv[i];
+		}
+		else
+		{
+			std::fprintf(stderr, "Usage: %s [goldens.json] [-t threads] [--record]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	json goldens = json::object();
+	if ( !record )
+	{
+		std::ifstream file(goldensFile);
+		if ( !file )
+		{
+			std::fprintf(stderr, "Can't open %s, goldens are written by --record\n", goldensFile.c_str());
+			return 2;
+		}
+		try
+		{
+			goldens = json::parse(file).at("scenarios");
+		}
+		catch ( const json::exception &exception )
+		{
+			std::fprintf(stderr, "Can't read goldens from %s: %s\n", goldensFile.c_str(), exception.what());
+			return 2;
+		}
+	}
+
+	const auto bestImplementation = AntsMovement::GetImplementation();
+
+	// Worlds and colonies report their progress, it would be mixed into the results
+	std::streambuf *coutBuffer = std::cout.rdbuf(nullptr);
+
+	Settings settings;
+	json     recorded = json::object();
+	int      failures = 0;
+	for ( const Scenario &scenario: CreateScenarios())
+	{
+		std::printf("%s, %d ticks\n", scenario.name.c_str(), scenario.ticks);
+		std::fflush(stdout);
+
+		const StateHash reference = Run(settings, scenario, 1, AntsMovement::Implementation::Scalar);
+		const StateHash optimized = Run(settings, scenario, threads, bestImplementation);
+		PrintHash("reference", reference);
+
+		if ( optimized != reference )
+		{
+			PrintHash(( std::to_string(threads) + " threads" ).c_str(), optimized);
+			std::printf("  FAILED: %d threads with optimized implementations differ from the reference\n", threads);
+			++failures;
+		}
+
+		recorded[scenario.name] = ToJson(reference);
+		if ( record )
+		{
+			continue;
+		}
+
+		if ( !goldens.contains(scenario.name))
+		{
+			std::printf("  FAILED: no golden\n");
+			++failures;
+		}
+		else if ( goldens[scenario.name] != recorded[scenario.name] )
+		{
+			const json &golden = goldens[scenario.name];
+			std::printf("  FAILED: differs from golden %s\n", golden.dump().c_str());
+			++failures;
+		}
+		std::fflush(stdout);
+	}
+
+	std::cout.rdbuf(coutBuffer);
+	std::cout.clear();
+
+	if ( record )
+	{
+		if ( failures > 0 )
+		{
+			std::fprintf(stderr, "Goldens aren't recorded, runs disagree\n");
+			return 1;
+		}
+
+		std::ofstream file(goldensFile);
+		if ( !file )
+		{
+			std::fprintf(stderr, "Can't write %s\n", goldensFile.c_str());
+			return 2;
+		}
+		file << json{{"seed", k_seed}, {"scenarios", recorded}}.dump(4) << std::endl;
+		std::printf("Goldens written to %s\n", goldensFile.c_str());
+		return 0;
+	}
+
+	std::printf("%d failures\n", failures);
+	return failures > 0 ? 1 : 0;
+}
@@ -6,6 +6,8 @@
 #include "Simulation.hpp"
 #include "Brush.hpp"
 #include "ColorConvert.hpp"
+#include "Profiler.hpp"
+#include "Tracer.hpp"
 
 void HelpTooltip(const std::string &text)
 {
@@ -29,8 +31,10 @@ void Gui::ShowMainSettings(Simulation &simulation)
 	bool &pause                = simulation.m_pause;
 	bool &adaptiveSpeed        = simulation.m_adaptiveSpeed;
 	bool &showAdvancedSettings = simulation.m_showAdvancedSettings;
+	bool &showProfiler         = simulation.m_showProfiler;
 
-	float &gameSpeed = simulation.m_gameSpeed;
+	float &gameSpeed  = simulation.m_gameSpeed;
+	float &tickBudget = simulation.m_tickBudget;
 
 	ImGui::Begin("Main settings");
 	{
@@ -52,10 +56,20 @@ void Gui::ShowMainSettings(Simulation &simulation)
 			ImGui::SliderFloat("[+][-] Simulation speed", &gameSpeed,
 			                   simulation.k_minGameSpeed, simulation.k_maxGameSpeed);
 
+			if ( adaptiveSpeed )
+			{
+				ImGui::SliderFloat("Tick budget per frame (ms)", &tickBudget,
+				                   simulation.k_minTickBudget, simulation.k_maxTickBudget);
+			}
+
 			if ( ImGui::Button("Reset speed"))
 			{
 				simulation.m_gameSpeed = 1;
 			}
+
+			const SimulationThread &simulationThread = *simulation.m_simulationThread;
+			ImGui::Text("Achieved speed: %.2f / %.2f", simulationThread.GetAchievedSpeed(), pause ? 0.f : gameSpeed);
+			ImGui::Text("Tick cost: %.2f ms", simulationThread.GetTickCost() * 1000.0);
 		}
 
 		ImGui::SeparatorText("Other");
@@ -70,7 +84,7 @@ void Gui::ShowMainSettings(Simulation &simulation)
 
 		if ( ImGui::Button("Clear map"))
 		{
-			simulation.m_world->ClearMap();
+			simulation.m_simulationThread->ClearMap();
 		}
 
 		if ( ImGui::Button("Reset camera"))
@@ -81,16 +95,38 @@ void Gui::ShowMainSettings(Simulation &simulation)
 		ImGui::Separator();
 
 		ImGui::Checkbox("Show advanced settings", &showAdvancedSettings);
+		ImGui::SameLine();
+		ImGui::Checkbox("Show profiler", &showProfiler);
 
 		static std::string fileName;
 		ImGui::InputText("image", &fileName);
 		if ( ImGui::Button("load world from image"))
 		{
-			// Very ugly
-			if ( simulation.m_world->LoadWorldFromImage(simulation.m_settings, fileName))
-			{
-				simulation.m_coloniesManager = std::make_unique<ColoniesManager>(simulation.m_world->GetTileMap());
-			}
+			simulation.LoadWorldFromImage(fileName);
+		}
+
+		bool autosaveChanged = ImGui::InputText("checkpoint", &simulation.m_saveFilename);
+		autosaveChanged |= ImGui::InputInt("autosave ticks", &simulation.m_autosaveInterval, 100, 1000);
+		if ( autosaveChanged )
+		{
+			simulation.m_autosaveInterval = std::max(simulation.m_autosaveInterval, 0);
+			simulation.m_simulationThread->SetAutosave(simulation.m_saveFilename,
+			                                           static_cast<uint64_t>(simulation.m_autosaveInterval));
+		}
+		if ( ImGui::Button("Save checkpoint"))
+		{
+			simulation.m_simulationThread->SaveCheckpoint(simulation.m_saveFilename);
+		}
+		ImGui::SameLine();
+		if ( ImGui::Button("Load checkpoint"))
+		{
+			simulation.m_simulationThread->LoadCheckpoint(simulation.m_saveFilename);
+		}
+
+		const std::string checkpointStatus = simulation.m_simulationThread->GetCheckpointStatus();
+		if ( !checkpointStatus.empty())
+		{
+			ImGui::TextUnformatted(checkpointStatus.c_str());
 		}
 	}
 	ImGui::End();
@@ -101,6 +137,77 @@ void Gui::ShowStatistics()
 //	ImGui::Value("Ants amount", static_cast<int>(coloniesManager->GetColonies()[0]->GetAntsAmount()));
 }
 
+void Gui::ShowProfiler()
+{
+	const Profiler &profiler = Profiler::Instance();
+
+	ImGui::Begin("Profiler");
+	{
+		ImGui::TextUnformatted("Milliseconds over the last samples, phases nest in Tick and Frame");
+
+		const ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV;
+		if ( ImGui::BeginTable("Phases", 6, flags))
+		{
+			ImGui::TableSetupColumn("Phase");
+			ImGui::TableSetupColumn("Last");
+			ImGui::TableSetupColumn("Min");
+			ImGui::TableSetupColumn("Avg");
+			ImGui::TableSetupColumn("P99");
+			ImGui::TableSetupColumn("History", ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableHeadersRow();
+
+			for ( int i = 0; i < Profiler::PhasesAmount; ++i )
+			{
+				const auto            phase = static_cast<Profiler::Phase>(i);
+				const Profiler::Stats stats = profiler.GetStats(phase);
+
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(Profiler::GetPhaseName(phase));
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", stats.last);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", stats.min);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", stats.avg);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", stats.p99);
+				ImGui::TableNextColumn();
+				ImGui::PushID(i);
+				ImGui::PlotLines("##History", stats.history.data(), static_cast<int>(stats.samplesAmount), 0, nullptr,
+				                 0.f, FLT_MAX, {-1, 20});
+				ImGui::PopID();
+			}
+			ImGui::EndTable();
+		}
+
+		if ( ImGui::Button("Clear"))
+		{
+			Profiler::Instance().Clear();
+		}
+
+		// Timeline of every thread, ends with the last Tracer::k_eventsPerThread events of each
+		Tracer &tracer = Tracer::Instance();
+		ImGui::SameLine();
+		if ( !tracer.IsEnabled() && ImGui::Button("Start trace"))
+		{
+			tracer.Start();
+		}
+		else if ( tracer.IsEnabled() && ImGui::Button("Stop trace"))
+		{
+			tracer.Stop();
+			m_traceStatus = tracer.Write(k_traceFilename) ? "Trace written" : "Can't write trace";
+		}
+		HelpTooltip(std::string("Written to ") + k_traceFilename + ", opens in Perfetto (ui.perfetto.dev)");
+
+		if ( !m_traceStatus.empty())
+		{
+			ImGui::TextUnformatted(m_traceStatus.c_str());
+		}
+	}
+	ImGui::End();
+}
+
 void Gui::ShowAdvancedSettings(Settings &settings)
 {
 	ImGui::Begin("Advanced settings");
@@ -181,6 +288,13 @@ void Gui::ShowAntColonySettings(AntColonySettings &antColonySettings)
 	if ( ImGui::TreeNode("Ant Colony"))
 	{
 		ImGui::PushItemWidth(200);
+		int coloniesAmount = static_cast<int>(antColonySettings.coloniesAmount);
+		if ( ImGui::InputInt("Colonies amount", &coloniesAmount))
+		{
+			antColonySettings.coloniesAmount = static_cast<size_t>(std::max(coloniesAmount, 1));
+		}
+		HelpTooltip("Every colony has its own nest, ants and pheromones. Applied on restart.");
+
 		if ( ImGui::InputInt("Ants start amount", &antColonySettings.antsStartAmount))
 		{
 			antColonySettings.antsStartAmount = std::max(antColonySettings.antsStartAmount, 1);
@@ -207,6 +321,16 @@ void Gui::ShowAntColonySettings(AntColonySettings &antColonySettings)
 			}
 		}
 
+		if ( ImGui::InputInt("Sort interval", &antColonySettings.antsSortInterval))
+		{
+			antColonySettings.antsSortInterval = std::max(antColonySettings.antsSortInterval, 0);
+		}
+		HelpTooltip("Ticks between re-sorting ants by position, improves cache usage. 0 disables it.");
+
+		ImGui::Checkbox("Large population", &antColonySettings.largePopulation);
+		HelpTooltip("For millions of ants. Ants are drawn as their density on the map instead of one by one.\n"
+		            "Applied on restart.");
+
 
 		ImGui::PopItemWidth();
 		ImGui::TreePop();
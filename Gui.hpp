@@ -12,6 +12,7 @@ public:
 	void ShowMainSettings(Simulation &simulation);
 	void ShowStatistics();
 	void ShowAdvancedSettings(Settings &settings);
+	void ShowProfiler();
 
 	bool ShouldHandleInput();
 
@@ -25,6 +26,12 @@ private:
 
 	void ShowBrushSettings(Brush &brush);
 
+private:
+	static constexpr const char *k_traceFilename = "trace.json";
+
+	// Outcome of writing the last trace
+	std::string m_traceStatus;
+
 };
 
 
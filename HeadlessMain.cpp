@@ -0,0 +1,348 @@
+// Runs the simulation without a window at full CPU speed, for batch runs driven by scripts.
+// Usage: Ants-headless <settings.json> [ticks] [--seed N] [--map image] [--csv metrics.csv] [--interval N]
+//                      [--trace trace.json] [--resume checkpoint] [--checkpoint checkpoint]
+//        Ants-headless <settings.json> --sweep sweep.json [--csv results.csv]
+// Settings are in the format written by Settings::Save. Seed replaces the seed of the settings,
+// map image is decoded here, see World::LoadWorldFromColors. Metrics are written every interval ticks.
+// With --trace every tick is traced and the timeline is written as Chrome trace-event JSON.
+// With --resume the run continues from a checkpoint, settings are replaced by the ones saved in it,
+// with --checkpoint the state is saved after the last tick, see Checkpoint.
+// With --sweep the settings are varied as described in sweep.json, see Sweep::Load, all runs share one
+// thread pool and the mean of every metric with its 95% confidence interval is written per combination.
+// Exits with 0 on success, with 1 when the run fails and with 2 on bad arguments.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <external/stb_image.h>
+
+#include "Settings.hpp"
+#include "Experiment.hpp"
+#include "Tracer.hpp"
+#include "Sweep.hpp"
+#include "Checkpoint.hpp"
+
+constexpr int k_exitFailure = 1;
+constexpr int k_exitUsage   = 2;
+
+struct Options
+{
+	std::string settingsFile;
+	long        ticks    = 1000;
+	long        interval = 100;
+	bool        hasSeed  = false;
+	int         seed     = 0;
+	std::string mapFile;
+	std::string csvFile;
+	std::string traceFile;
+	std::string sweepFile;
+	std::string resumeFile;
+	std::string checkpointFile;
+};
+
+bool ParseOptions(int argc, char **argv, Options &options)
+{
+	if ( argc < 2 )
+	{
+		return false;
+	}
+	options.settingsFile = argv[1];
+
+	for ( int i = 2; i < argc; ++i )
+	{
+		const bool hasValue = i + 1 < argc;
+		if ( std::strcmp(argv[i], "--seed") == 0 && hasValue )
+		{
+			options.hasSeed = true;
+			options.seed    = std::atoi(argv[++i]);
+		}
+		else if ( std::strcmp(argv[i], "--map") == 0 && hasValue )
+		{
+			options.mapFile = argv[++i];
+		}
+		else if ( std::strcmp(argv[i], "--csv") == 0 && hasValue )
+		{
+			options.csvFile = argv[++i];
+		}
+		else if ( std::strcmp(argv[i], "--interval") == 0 && hasValue )
+		{
+			options.interval = std::atol(argv[++i]);
+		}
+		else if ( std::strcmp(argv[i], "--trace") == 0 && hasValue )
+		{
+			options.traceFile = argv[++i];
+		}
+		else if ( std::strcmp(argv[i], "--sweep") == 0 && hasValue )
+		{
+			options.sweepFile = argv[++i];
+		}
+		else if ( std::strcmp(argv[i], "--resume") == 0 && hasValue )
+		{
+			options.resumeFile = argv[++i];
+		}
+		else if ( std::strcmp(argv[i], "--checkpoint") == 0 && hasValue )
+		{
+			options.checkpointFile = argv[++i];
+		}
+		else if ( argv[i][0] != '-' )
+		{
+			options.ticks = std::atol(argv[i]);
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	// Sweeps generate their own worlds and aren't traced
+	if ( !options.sweepFile.empty() && ( !options.mapFile.empty() || !options.traceFile.empty() ||
+	                                     !options.resumeFile.empty() || !options.checkpointFile.empty()))
+	{
+		return false;
+	}
+	// Resumed world is the saved one
+	if ( !options.resumeFile.empty() && ( !options.mapFile.empty() || options.hasSeed ))
+	{
+		return false;
+	}
+
+	return options.ticks >= 0 && options.interval > 0;
+}
+
+bool LoadMap(const std::string &filename, Experiment::Map &map)
+{
+	int     channels = 0;
+	stbi_uc *pixels  = stbi_load(filename.c_str(), &map.width, &map.height, &channels, 4);
+	if ( pixels == nullptr )
+	{
+		return false;
+	}
+
+	map.colors.resize(static_cast<size_t>(map.width) * map.height);
+	std::memcpy(map.colors.data(), pixels, map.colors.size() * sizeof(Color));
+	stbi_image_free(pixels);
+	return true;
+}
+
+// Prints why the experiment can't be created and returns null then
+std::unique_ptr<Experiment> CreateExperiment(const Options &options, Settings &settings)
+{
+	if ( !options.resumeFile.empty())
+	{
+		std::unique_ptr<World>           world;
+		std::unique_ptr<ColoniesManager> coloniesManager;
+		uint64_t                         tick  = 0;
+		const std::string                error = Checkpoint::Load(options.resumeFile, settings, world, coloniesManager,
+		                                                          tick);
+		if ( !error.empty())
+		{
+			std::fprintf(stderr, "Can't resume from %s: %s\n", options.resumeFile.c_str(), error.c_str());
+			return nullptr;
+		}
+		return std::make_unique<Experiment>(std::move(world), std::move(coloniesManager), static_cast<long>(tick));
+	}
+
+	Experiment::Map map;
+	if ( !options.mapFile.empty() && !LoadMap(options.mapFile, map))
+	{
+		std::fprintf(stderr, "Map image %s can't be read\n", options.mapFile.c_str());
+		return nullptr;
+	}
+	return std::make_unique<Experiment>(settings, options.mapFile.empty() ? nullptr : &map);
+}
+
+int RunSweep(const Options &options, const Settings &settings, std::streambuf *stdoutBuffer)
+{
+	Sweep sweep;
+	try
+	{
+		std::ifstream file(options.sweepFile);
+		if ( !file )
+		{
+			std::fprintf(stderr, "Sweep file %s not found\n", options.sweepFile.c_str());
+			return k_exitFailure;
+		}
+
+		const std::string error = sweep.Load(nlohmann::json::parse(file), settings);
+		if ( !error.empty())
+		{
+			std::fprintf(stderr, "Sweep file %s: %s\n", options.sweepFile.c_str(), error.c_str());
+			return k_exitUsage;
+		}
+	}
+	catch ( const nlohmann::json::exception &exception )
+	{
+		std::fprintf(stderr, "Sweep file %s can't be read: %s\n", options.sweepFile.c_str(), exception.what());
+		return k_exitUsage;
+	}
+
+	std::ofstream csv;
+	if ( !options.csvFile.empty())
+	{
+		csv.open(options.csvFile);
+		if ( !csv )
+		{
+			std::fprintf(stderr, "Can't write results to %s\n", options.csvFile.c_str());
+			return k_exitFailure;
+		}
+	}
+
+	const size_t runsAmount = sweep.GetRunsAmount();
+	const auto   start      = std::chrono::steady_clock::now();
+	const auto   results    = sweep.Run([runsAmount](size_t finishedRuns)
+	{
+		std::fprintf(stderr, "\r%zu/%zu runs", finishedRuns, runsAmount);
+	});
+	const double seconds    = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::fprintf(stderr, "\n");
+
+	// Without a file results go to the standard output, which is silenced while running
+	std::ostream output(csv.is_open() ? csv.rdbuf() : stdoutBuffer);
+	sweep.WriteCsv(output, results);
+	output.flush();
+	if ( csv.is_open())
+	{
+		csv.close();
+		if ( !csv )
+		{
+			std::fprintf(stderr, "Can't write results to %s\n", options.csvFile.c_str());
+			return k_exitFailure;
+		}
+	}
+
+	std::fprintf(stderr, "%zu runs of %zu combinations in %.3f s\n", runsAmount, results.size(), seconds);
+	return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+	Options options;
+	if ( !ParseOptions(argc, argv, options))
+	{
+		std::fprintf(stderr, "Usage: %s <settings.json> [ticks] [--seed N] [--map image] [--csv metrics.csv] "
+		                     "[--interval N] [--trace trace.json] [--resume checkpoint] [--checkpoint checkpoint]\n"
+		                     "       %s <settings.json> --sweep sweep.json [--csv results.csv]\n", argv[0], argv[0]);
+		return k_exitUsage;
+	}
+
+	if ( !std::filesystem::is_regular_file(options.settingsFile))
+	{
+		std::fprintf(stderr, "Settings file %s not found\n", options.settingsFile.c_str());
+		return k_exitFailure;
+	}
+
+	// Settings, worlds and colonies report their progress, it would bury the results of batch runs
+	std::streambuf *coutBuffer = std::cout.rdbuf(nullptr);
+
+	Settings settings;
+	if ( !settings.Load(options.settingsFile))
+	{
+		std::fprintf(stderr, "Settings file %s can't be read\n", options.settingsFile.c_str());
+		return k_exitFailure;
+	}
+	if ( options.hasSeed )
+	{
+		settings.GetWorldGenerationSettings().seed = options.seed;
+	}
+
+	if ( !options.sweepFile.empty())
+	{
+		const int result = RunSweep(options, settings, coutBuffer);
+		std::cout.rdbuf(coutBuffer);
+		std::cout.clear();
+		return result;
+	}
+
+	std::ofstream csv;
+	if ( !options.csvFile.empty())
+	{
+		csv.open(options.csvFile);
+		if ( !csv )
+		{
+			std::fprintf(stderr, "Can't write metrics to %s\n", options.csvFile.c_str());
+			return k_exitFailure;
+		}
+	}
+
+	const std::unique_ptr<Experiment> experiment = CreateExperiment(options, settings);
+	if ( !experiment )
+	{
+		return k_exitFailure;
+	}
+	if ( csv.is_open())
+	{
+		Experiment::WriteCsvHeader(csv, experiment->GetColoniesAmount());
+	}
+
+	if ( !options.traceFile.empty())
+	{
+		Tracer::Instance().Start();
+	}
+
+	Experiment::Metrics lastMetrics;
+	const auto          start = std::chrono::steady_clock::now();
+	experiment->Run(options.ticks, options.interval, [&](const Experiment::Metrics &metrics)
+	{
+		if ( csv.is_open())
+		{
+			Experiment::WriteCsvRow(csv, metrics);
+		}
+		lastMetrics = metrics;
+	});
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	if ( !options.checkpointFile.empty())
+	{
+		const auto checkpointStart = std::chrono::steady_clock::now();
+		if ( !experiment->SaveCheckpoint(options.checkpointFile, settings))
+		{
+			std::fprintf(stderr, "Can't write checkpoint to %s\n", options.checkpointFile.c_str());
+			return k_exitFailure;
+		}
+		std::printf("Checkpoint written to %s in %.3f s\n", options.checkpointFile.c_str(),
+		            std::chrono::duration<double>(std::chrono::steady_clock::now() - checkpointStart).count());
+	}
+
+	std::cout.rdbuf(coutBuffer);
+	std::cout.clear();
+
+	if ( !options.traceFile.empty())
+	{
+		Tracer::Instance().Stop();
+		if ( !Tracer::Instance().Write(options.traceFile))
+		{
+			std::fprintf(stderr, "Can't write trace to %s\n", options.traceFile.c_str());
+			return k_exitFailure;
+		}
+		std::printf("Trace written to %s\n", options.traceFile.c_str());
+	}
+
+	if ( csv.is_open())
+	{
+		csv.close();
+		if ( !csv )
+		{
+			std::fprintf(stderr, "Can't write metrics to %s\n", options.csvFile.c_str());
+			return k_exitFailure;
+		}
+	}
+
+	size_t antsAmount = 0;
+	for ( size_t colony = 0; colony < lastMetrics.ants.size(); ++colony )
+	{
+		std::printf("Colony %zu: %zu ants, %ld food delivered\n", colony, lastMetrics.ants[colony],
+		            lastMetrics.foodDelivered[colony]);
+		antsAmount += lastMetrics.ants[colony];
+	}
+	std::printf("%ld ticks in %.3f s, %.3f ms/tick, %zu ants, %ld food remaining\n", options.ticks, seconds,
+	            options.ticks > 0 ? seconds * 1000.0 / static_cast<double>(options.ticks) : 0.0, antsAmount,
+	            lastMetrics.foodRemaining);
+
+	return EXIT_SUCCESS;
+}
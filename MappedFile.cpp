@@ -0,0 +1,138 @@
+#include "MappedFile.hpp"
+
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const std::string &filename)
+{
+	Close();
+	return Map(filename) || Read(filename);
+}
+
+void MappedFile::Close()
+{
+	if ( m_mapping )
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(m_mapping);
+#else
+		munmap(m_mapping, m_size);
+#endif
+		m_mapping = nullptr;
+	}
+
+	m_buffer.clear();
+	m_buffer.shrink_to_fit();
+	m_data = nullptr;
+	m_size = 0;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Map(const std::string &filename)
+{
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+	                          FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if ( file == INVALID_HANDLE_VALUE )
+	{
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if ( !GetFileSizeEx(file, &size) || size.QuadPart == 0 )
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	// View keeps the mapping and the file open
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if ( mapping == nullptr )
+	{
+		return false;
+	}
+
+	m_mapping = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if ( m_mapping == nullptr )
+	{
+		return false;
+	}
+
+	m_data = static_cast<const uint8_t *>(m_mapping);
+	m_size = static_cast<size_t>(size.QuadPart);
+	return true;
+}
+
+#else
+
+bool MappedFile::Map(const std::string &filename)
+{
+	const int file = open(filename.c_str(), O_RDONLY);
+	if ( file < 0 )
+	{
+		return false;
+	}
+
+	struct stat status{};
+	if ( fstat(file, &status) != 0 || status.st_size == 0 )
+	{
+		close(file);
+		return false;
+	}
+
+	const auto size    = static_cast<size_t>(status.st_size);
+	void       *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if ( mapping == MAP_FAILED )
+	{
+		return false;
+	}
+
+	// Sections are copied front to back
+	madvise(mapping, size, MADV_SEQUENTIAL);
+
+	m_mapping = mapping;
+	m_data    = static_cast<const uint8_t *>(mapping);
+	m_size    = size;
+	return true;
+}
+
+#endif
+
+bool MappedFile::Read(const std::string &filename)
+{
+	std::ifstream file(filename, std::ios::binary | std::ios::ate);
+	if ( !file )
+	{
+		return false;
+	}
+
+	m_buffer.resize(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	if ( !file.read(reinterpret_cast<char *>(m_buffer.data()), static_cast<std::streamsize>(m_buffer.size())))
+	{
+		m_buffer.clear();
+		return false;
+	}
+
+	m_data = m_buffer.data();
+	m_size = m_buffer.size();
+	return true;
+}
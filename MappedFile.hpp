@@ -0,0 +1,42 @@
+#ifndef ANTS_MAPPEDFILE_HPP
+#define ANTS_MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* Read-only view of a whole file. The file is mapped into memory, so only pages which are touched
+ * are read from disk. Where it can't be mapped it's read into memory instead.
+ * Windows headers aren't included by this header, they clash with raylib */
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	bool Open(const std::string &filename);
+	void Close();
+
+	const uint8_t *GetData() const { return m_data; }
+	size_t GetSize() const { return m_size; }
+
+	bool IsMapped() const { return m_mapping != nullptr; }
+
+private:
+	bool Map(const std::string &filename);
+	bool Read(const std::string &filename);
+
+private:
+	const uint8_t *m_data = nullptr;
+	size_t        m_size  = 0;
+
+	// Start of the mapped view, null when the file was read
+	void                 *m_mapping = nullptr;
+	std::vector<uint8_t> m_buffer;
+};
+
+#endif //ANTS_MAPPEDFILE_HPP
@@ -16,7 +16,8 @@ Nest::Nest(NestId id, AntColony *colony, const IntVec2 &pos, TileMap &tileMap) :
 	//m_screenPos = globalSettings.WorldToScreen(m_pos);
 
 	m_size       = antColonySettings.nestSize;
-	m_foodStored = 0;
+	m_foodStored    = 0;
+	m_foodDelivered = 0;
 
 	tileMap.PlaceNest(*this);
 }
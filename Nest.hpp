@@ -12,6 +12,9 @@ class AntColony;
 
 class Nest
 {
+	// Saves and restores state which isn't exposed otherwise
+	friend class Checkpoint;
+
 public:
 	Nest(NestId id, AntColony *colony, const IntVec2 &pos, TileMap &tileMap);
 
@@ -23,6 +26,9 @@ public:
 	NestId GetId() const { return m_id; }
 	AntColony *GetColony() const { return m_colony; }
 
+	// Food ever brought to the nest, including food spent on new ants
+	int GetFoodDelivered() const { return m_foodDelivered; }
+
 	int GetSize() const { return m_size; };
 	const IntVec2 &GetPos() const { return m_pos; };
 	const Vector2 &GetScreenPos() const { return m_screenPos; };
@@ -40,11 +46,13 @@ private:
 	int m_size;
 
 	int m_foodStored;
+	int m_foodDelivered;
 };
 
 void Nest::AddFoodToStorage()
 {
 	++m_foodStored;
+	++m_foodDelivered;
 	OnFoodStoredIncrease();
 }
 
@@ -1,34 +1,29 @@
 #include "PheromoneMap.hpp"
-
-#include <omp.h>
+#include "Profiler.hpp"
+#include "Tracer.hpp"
 
 constexpr float k_pheromoneMinIntensity     = 0.f;
 constexpr float k_pheromoneMaxIntensity     = 255.f;
 constexpr float k_lostEvaporationMultiplier = 16.f;
 
-PheromoneMap::PheromoneMap(size_t width, size_t height, float evaporationRate)
+constexpr int k_maxDepositBandsAmount = 64;
+constexpr int k_evaporationRowsPerTask = 16;
+
+PheromoneMap::PheromoneMap(size_t width, size_t height, size_t coloniesAmount, float evaporationRate)
 		:
-		m_width(static_cast<int>(width)), m_height(static_cast<int>(height)), m_evaporationRate(evaporationRate),
+		m_width(static_cast<int>(width)), m_height(static_cast<int>(height)),
+		m_coloniesAmount(coloniesAmount), m_channelsAmount(coloniesAmount * Type::Amount),
+		m_evaporationRate(evaporationRate),
+		m_pheromones(width * height * m_channelsAmount, 0.f),
 		m_colorMap(m_width, m_height, {0, 0, 0, 0}),
 		m_boundsChecker(0, m_width, 0, m_height)
 {
-	for ( int i = 0; i < PheromoneType::Amount; ++i )
-	{
-		m_pheromones[i].resize(m_height);
-		for ( int y = 0; y < m_height; ++y )
-		{
-			m_pheromones[i][y].resize(m_width);
-			for ( int x = 0; x < m_width; ++x )
-			{
-				m_pheromones[i][y][x] = 0.f;
-			}
-			m_pheromones[i][y].shrink_to_fit();
-		}
-		m_pheromones[i].shrink_to_fit();
-	}
-
 	m_updateTimer.SetDelay(10);
 	m_visualUpdateTimer.SetDelay(50);
+
+	m_depositBandsAmount = std::max(std::min(m_height, k_maxDepositBandsAmount), 1);
+	m_sortedAdd.offsets.resize(m_depositBandsAmount + 1);
+	m_sortedSubstract.offsets.resize(m_depositBandsAmount + 1);
 }
 
 void PheromoneMap::Update()
@@ -36,103 +31,234 @@ void PheromoneMap::Update()
 	m_updateTimer.Update(1);
 	if ( m_updateTimer.IsElapsed())
 	{
-		Evaporate();
+		m_evaporationPending = true;
 		m_updateTimer.Reset();
 	}
 
 	m_visualUpdateTimer.Update(1);
 	if ( m_visualUpdateTimer.IsElapsed())
 	{
-		m_colorMap.Update();
+		UpdateColors();
 		m_visualUpdateTimer.Reset();
 	}
 }
 
 void PheromoneMap::Clear()
 {
-	for ( int y = 0; y < m_height; ++y )
+	std::fill(m_pheromones.begin(), m_pheromones.end(), 0.f);
+	UpdateColors();
+}
+
+void PheromoneMap::Add(AntColonyId colonyId, Type pheromoneType, int x, int y, float intensity)
+{
+	if ( !m_boundsChecker.IsInBounds(x, y))
 	{
-		for ( int x = 0; x < m_width; ++x )
-		{
-			m_pheromones[Food][y][x] = 0.f;
-			m_pheromones[Nest][y][x] = 0.f;
-			m_pheromones[Lost][y][x] = 0.f;
-			UpdateColor(x, y);
-		}
+		return;
 	}
-	m_colorMap.Update();
+
+	float &value = m_pheromones[GetIndex(colonyId, pheromoneType, x, y)];
+	value = std::max(value, intensity);
 }
 
-void PheromoneMap::Add(Type pheromoneType, int x, int y, float intensity)
+void PheromoneMap::Substract(AntColonyId colonyId, PheromoneMap::Type pheromoneType, int x, int y, float intensity)
 {
 	if ( !m_boundsChecker.IsInBounds(x, y))
 	{
 		return;
 	}
 
-	m_pheromones[pheromoneType][y][x] = std::max(m_pheromones[pheromoneType][y][x], intensity);
+	float &value = m_pheromones[GetIndex(colonyId, pheromoneType, x, y)];
+	value = std::max(value - intensity, 0.f);
 }
 
-void PheromoneMap::Substract(PheromoneMap::Type pheromoneType, int x, int y, float intensity)
+void PheromoneMap::Set(AntColonyId colonyId, Type pheromoneType, int x, int y, float intensity)
 {
 	if ( !m_boundsChecker.IsInBounds(x, y))
 	{
 		return;
 	}
 
-	m_pheromones[pheromoneType][y][x] = std::max(m_pheromones[pheromoneType][y][x] - intensity, 0.f);
+	m_pheromones[GetIndex(colonyId, pheromoneType, x, y)] = intensity;
 }
 
-void PheromoneMap::Set(Type pheromoneType, int x, int y, float intensity)
+void PheromoneMap::QueueAdd(AntColonyId colonyId, Type pheromoneType, const IntVec2 &pos, float intensity)
 {
-	if ( !m_boundsChecker.IsInBounds(x, y))
+	if ( !m_boundsChecker.IsInBounds(pos))
 	{
 		return;
 	}
 
-	m_pheromones[pheromoneType][y][x] = intensity;
+	m_depositBuffers.Local().add.push_back(
+			{pos.x, pos.y, GetIndex(colonyId, pheromoneType, pos.x, pos.y), intensity});
 }
 
-void PheromoneMap::Draw() const
+void PheromoneMap::QueueSubstract(AntColonyId colonyId, Type pheromoneType, const IntVec2 &pos, float intensity)
 {
-	m_colorMap.Draw();
+	if ( !m_boundsChecker.IsInBounds(pos))
+	{
+		return;
+	}
+
+	m_depositBuffers.Local().substract.push_back(
+			{pos.x, pos.y, GetIndex(colonyId, pheromoneType, pos.x, pos.y), intensity});
+}
+
+void PheromoneMap::ApplyEvaporation()
+{
+	if ( m_evaporationPending )
+	{
+		Evaporate();
+		m_evaporationPending = false;
+	}
+}
+
+void PheromoneMap::ApplyDeposits()
+{
+	SortDeposits(&DepositBuffer::substract, m_sortedSubstract);
+	SortDeposits(&DepositBuffer::add, m_sortedAdd);
+
+#pragma omp taskloop grainsize(1) default(none) shared(m_sortedAdd, m_sortedSubstract, m_pheromones, m_depositBandsAmount)
+	for ( int band = 0; band < m_depositBandsAmount; ++band )
+	{
+		TraceScope traceScope("Deposits band", band);
+
+		for ( size_t i = m_sortedSubstract.offsets[band]; i < m_sortedSubstract.offsets[band + 1]; ++i )
+		{
+			const auto &deposit = m_sortedSubstract.deposits[i];
+			float      &value   = m_pheromones[deposit.index];
+			value = std::max(value - deposit.intensity, 0.f);
+		}
+
+		for ( size_t i = m_sortedAdd.offsets[band]; i < m_sortedAdd.offsets[band + 1]; ++i )
+		{
+			const auto &deposit = m_sortedAdd.deposits[i];
+			float      &value   = m_pheromones[deposit.index];
+			value = std::max(value, deposit.intensity);
+		}
+	}
+
+	m_depositBuffers.Resize();
+}
+
+void PheromoneMap::SortDeposits(std::vector<Deposit> DepositBuffer::*kind, SortedDeposits &sorted)
+{
+	// Counting sort by band, deposits keep the order of threads within a band
+	auto &offsets = sorted.offsets;
+	std::fill(offsets.begin(), offsets.end(), 0);
+	for ( size_t thread = 0; thread < m_depositBuffers.Size(); ++thread )
+	{
+		for ( const auto &deposit: m_depositBuffers[thread].*kind )
+		{
+			++offsets[GetBand(deposit.y) + 1];
+		}
+	}
+
+	for ( int band = 0; band < m_depositBandsAmount; ++band )
+	{
+		offsets[band + 1] += offsets[band];
+	}
+
+	// Resizing only grows the buffer, so it stops allocating once it reaches the peak amount of deposits
+	if ( sorted.deposits.size() < offsets.back())
+	{
+		sorted.deposits.resize(offsets.back());
+	}
+
+	for ( size_t thread = 0; thread < m_depositBuffers.Size(); ++thread )
+	{
+		auto &buffer = m_depositBuffers[thread];
+		for ( const auto &deposit: buffer.*kind )
+		{
+			// offsets[band] is the write position of the band until the end of the loop
+			sorted.deposits[offsets[GetBand(deposit.y)]++] = deposit;
+		}
+		( buffer.*kind ).clear();
+	}
+
+	// Writing advanced every offset to the beginning of the next band
+	for ( int band = m_depositBandsAmount; band > 0; --band )
+	{
+		offsets[band] = offsets[band - 1];
+	}
+	offsets[0] = 0;
 }
 
 void PheromoneMap::Evaporate()
 {
-#pragma omp parallel for default(none) shared(m_pheromones, m_evaporationRate, k_pheromoneMinIntensity)
+	const float lostEvaporationRate = m_evaporationRate * k_lostEvaporationMultiplier;
+
+	const int chunksAmount = ( m_height + k_evaporationRowsPerTask - 1 ) / k_evaporationRowsPerTask;
+
+	// Every chunk of rows is a task
+#pragma omp taskloop grainsize(1) default(none) shared(m_pheromones, m_evaporationRate, lostEvaporationRate, k_pheromoneMinIntensity, chunksAmount)
+	for ( int chunk = 0; chunk < chunksAmount; ++chunk )
+	{
+		const int begin = chunk * k_evaporationRowsPerTask;
+		const int end   = std::min(begin + k_evaporationRowsPerTask, m_height);
+
+		TraceScope traceScope("Evaporation rows", begin);
+
+		for ( int y = begin; y < end; ++y )
+		{
+			float *cell = m_pheromones.data() + static_cast<size_t>(y) * m_width * m_channelsAmount;
+			for ( int x = 0; x < m_width; ++x, cell += m_channelsAmount )
+			{
+				for ( size_t colony = 0; colony < m_coloniesAmount; ++colony )
+				{
+					float *values = cell + colony * Type::Amount;
+					values[Food] = std::max(values[Food] - m_evaporationRate, k_pheromoneMinIntensity);
+					values[Nest] = std::max(values[Nest] - m_evaporationRate, k_pheromoneMinIntensity);
+					values[Lost] = std::max(values[Lost] - lostEvaporationRate, k_pheromoneMinIntensity);
+				}
+			}
+		}
+	}
+}
+
+void PheromoneMap::UpdateColors()
+{
+	ProfileScope profileScope(Profiler::PheromoneColors);
+
+#pragma omp parallel for default(none)
 	for ( int y = 0; y < m_height; ++y )
 	{
 		for ( int x = 0; x < m_width; ++x )
 		{
-			m_pheromones[Food][y][x] = std::max(m_pheromones[Food][y][x] - m_evaporationRate, k_pheromoneMinIntensity);
-			m_pheromones[Nest][y][x] = std::max(m_pheromones[Nest][y][x] - m_evaporationRate, k_pheromoneMinIntensity);
-			m_pheromones[Lost][y][x] = std::max(
-					m_pheromones[Lost][y][x] - m_evaporationRate * k_lostEvaporationMultiplier,
-					k_pheromoneMinIntensity);
 			UpdateColor(x, y);
 		}
 	}
+	m_colorMap.Update();
 }
 
 void PheromoneMap::UpdateColor(int x, int y)
 {
+	// Shows the strongest pheromone of every type among all colonies
+	float lost = 0.f, food = 0.f, nest = 0.f;
+
+	const float *cell = m_pheromones.data() + GetIndex(0, Food, x, y);
+	for ( size_t colony = 0; colony < m_coloniesAmount; ++colony )
+	{
+		const float *values = cell + colony * Type::Amount;
+		lost = std::max(lost, values[Lost]);
+		food = std::max(food, values[Food]);
+		nest = std::max(nest, values[Nest]);
+	}
+
 	auto &color = m_colorMap.GetMutable(x, y);
-	auto r      = static_cast<unsigned char>(m_pheromones[Lost][y][x]);
-	auto g      = static_cast<unsigned char>(m_pheromones[Food][y][x]);
-	auto b      = static_cast<unsigned char>(m_pheromones[Nest][y][x]);
+	auto r      = static_cast<unsigned char>(lost);
+	auto g      = static_cast<unsigned char>(food);
 
 	if ( r > g )
 	{
-		color.r = static_cast<unsigned char>(m_pheromones[Lost][y][x]);
+		color.r = r;
 		color.g = 0;
 		color.b = 0;
 	}
 	else
 	{
 		color.r = 0;
-		color.g = static_cast<unsigned char>(m_pheromones[Food][y][x]);
-		color.b = static_cast<unsigned char>(m_pheromones[Nest][y][x]);
+		color.g = g;
+		color.b = static_cast<unsigned char>(nest);
 	}
 
 	int sum = color.r;
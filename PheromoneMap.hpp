@@ -4,17 +4,21 @@
 #include <cstdint>
 #include <vector>
 #include <memory>
-#include <raylib.h>
 #include <array>
 
 #include "IntVec.hpp"
+#include "Aliases.hpp"
 #include "BoundsChecker.hpp"
 #include "Timer.hpp"
+#include "PerThread.hpp"
 
 #include "ColorMap.hpp"
 
 class PheromoneMap
 {
+	// Saves and restores state which isn't exposed otherwise
+	friend class Checkpoint;
+
 public:
 	enum Type
 	{
@@ -22,46 +26,112 @@ public:
 	};
 
 public:
-	PheromoneMap(size_t width, size_t height, float evaporationRate);
+	/* Pheromones of all colonies are kept in one store. Channels of every colony are packed
+	 * next to each other in every cell, so evaporation sweeps the whole store once in order
+	 * and one texture shows pheromones of all colonies */
+	PheromoneMap(size_t width, size_t height, size_t coloniesAmount, float evaporationRate);
 
+	// Advances timers, evaporation found due here is deferred to ApplyEvaporation.
+	// Colors are recomputed here when they are due to be shown
 	void Update();
 
 	void Clear();
 
-	void Add(Type pheromoneType, int x, int y, float intensity);
-	inline void Add(Type pheromoneType, const IntVec2 &pos, float intensity)
+	void Add(AntColonyId colonyId, Type pheromoneType, int x, int y, float intensity);
+	inline void Add(AntColonyId colonyId, Type pheromoneType, const IntVec2 &pos, float intensity)
 	{
-		Add(pheromoneType, pos.x, pos.y, intensity);
+		Add(colonyId, pheromoneType, pos.x, pos.y, intensity);
 	}
 
-	void Substract(Type pheromoneType, int x, int y, float intensity);
-	inline void Substract(Type pheromoneType, const IntVec2 &pos, float intensity)
+	void Substract(AntColonyId colonyId, Type pheromoneType, int x, int y, float intensity);
+	inline void Substract(AntColonyId colonyId, Type pheromoneType, const IntVec2 &pos, float intensity)
 	{
-		Substract(pheromoneType, pos.x, pos.y, intensity);
+		Substract(colonyId, pheromoneType, pos.x, pos.y, intensity);
 	}
 
-	void Set(Type pheromoneType, int x, int y, float intensity);
-	inline void Set(Type pheromoneType, const IntVec2 &pos, float intensity)
+	void Set(AntColonyId colonyId, Type pheromoneType, int x, int y, float intensity);
+	inline void Set(AntColonyId colonyId, Type pheromoneType, const IntVec2 &pos, float intensity)
 	{
-		Set(pheromoneType, pos.x, pos.y, intensity);
+		Set(colonyId, pheromoneType, pos.x, pos.y, intensity);
 	}
 
-	inline float Get(Type pheromoneType, int x, int y) const;
-	inline float Get(Type pheromoneType, const IntVec2 &pos) const { return Get(pheromoneType, pos.x, pos.y); };
+	/* Deposits may be queued from parallel regions, every thread writes only to its own buffers.
+	 * ApplyDeposits applies all queued substractions first, then all additions,
+	 * so the result doesn't depend on the order of deposits or amount of threads */
+	void QueueAdd(AntColonyId colonyId, Type pheromoneType, const IntVec2 &pos, float intensity);
+	void QueueSubstract(AntColonyId colonyId, Type pheromoneType, const IntVec2 &pos, float intensity);
+
+	/* Evaporation and deposits are split into tasks by rows, so when called from a parallel region
+	 * they share threads with other tasks. Called outside of a parallel region they run serially */
+	void ApplyDeposits();
+	void ApplyEvaporation();
+
+	inline float Get(AntColonyId colonyId, Type pheromoneType, int x, int y) const;
+	inline float Get(AntColonyId colonyId, Type pheromoneType, const IntVec2 &pos) const
+	{
+		return Get(colonyId, pheromoneType, pos.x, pos.y);
+	};
+
+	int GetWidth() const { return m_width; }
+	int GetHeight() const { return m_height; }
+	size_t GetColoniesAmount() const { return m_coloniesAmount; }
 
-	void Draw() const;
+	// Every value of every colony, laid out as described by GetIndex
+	const std::vector<float> &GetValues() const { return m_pheromones; }
+
+	// Strongest pheromone of every type among all colonies
+	ColorMap &GetColorMap() { return m_colorMap; }
 
 private:
 	void Evaporate();
 
+	void UpdateColors();
 	void UpdateColor(int x, int y);
 
+	size_t GetIndex(AntColonyId colonyId, Type pheromoneType, int x, int y) const
+	{
+		return ( static_cast<size_t>(y) * m_width + x ) * m_channelsAmount + colonyId * Type::Amount + pheromoneType;
+	}
+
 private:
+	struct Deposit
+	{
+		int   x, y;
+		// Index of the value in the store
+		size_t index;
+		float  intensity;
+	};
+
+	// Each thread queues into one flat buffer per kind, ApplyDeposits sorts them by band of rows,
+	// so bands can be applied in parallel. Few flat buffers reach their peak size quickly
+	// and stop allocating, unlike a buffer per thread and band
+	struct DepositBuffer
+	{
+		std::vector<Deposit> add;
+		std::vector<Deposit> substract;
+	};
+
+	struct SortedDeposits
+	{
+		std::vector<Deposit> deposits;
+		// Deposits of band b are [offsets[b], offsets[b + 1])
+		std::vector<size_t>  offsets;
+	};
+
+	void SortDeposits(std::vector<Deposit> DepositBuffer::*kind, SortedDeposits &sorted);
+	int GetBand(int y) const { return y * m_depositBandsAmount / m_height; }
+
+
 	int m_width, m_height;
 
+	size_t m_coloniesAmount;
+	// Values of one cell, Type::Amount per colony
+	size_t m_channelsAmount;
+
 	float m_evaporationRate;
 
-	std::array<std::vector<std::vector<float>>, Type::Amount> m_pheromones;
+	// Value of colony c, type t in cell (x, y) is at ((y * width + x) * channels + c * Type::Amount + t)
+	std::vector<float> m_pheromones;
 
 	ColorMap m_colorMap;
 
@@ -69,13 +139,20 @@ private:
 	Timer m_visualUpdateTimer;
 
 	BoundsChecker2D m_boundsChecker;
+
+	bool m_evaporationPending = false;
+
+	int                      m_depositBandsAmount;
+	PerThread<DepositBuffer> m_depositBuffers;
+	SortedDeposits           m_sortedAdd;
+	SortedDeposits           m_sortedSubstract;
 };
 
 using PheromoneType = PheromoneMap::Type;
 
-float PheromoneMap::Get(PheromoneType pheromoneType, int x, int y) const
+float PheromoneMap::Get(AntColonyId colonyId, PheromoneType pheromoneType, int x, int y) const
 {
-	return m_boundsChecker.IsInBounds(x, y) ? m_pheromones[pheromoneType][y][x] : 0.f;
+	return m_boundsChecker.IsInBounds(x, y) ? m_pheromones[GetIndex(colonyId, pheromoneType, x, y)] : 0.f;
 }
 
 #endif //ANTS_PHEROMONEMAP_HPP
@@ -0,0 +1,83 @@
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+Profiler &Profiler::Instance()
+{
+	static Profiler profiler;
+	return profiler;
+}
+
+const char *Profiler::GetPhaseName(Phase phase)
+{
+	static constexpr std::array<const char *, PhasesAmount> k_names = {
+			"Tick", "Evaporation", "Ants update", "Food", "Post-update", "Pheromone colors", "Tile map update",
+			"Brush painting", "Snapshot", "Checkpoint capture", "Checkpoint write",
+			"Frame", "Texture upload", "Draw", "Gui"
+	};
+	return k_names[phase];
+}
+
+void Profiler::Record(Phase phase, double milliseconds)
+{
+	Samples &samples = m_phases[phase];
+
+	std::lock_guard lock(samples.mutex);
+	samples.values[samples.next] = static_cast<float>(milliseconds);
+	samples.next   = ( samples.next + 1 ) % k_samplesAmount;
+	samples.amount = std::min(samples.amount + 1, k_samplesAmount);
+}
+
+Profiler::Stats Profiler::GetStats(Phase phase) const
+{
+	const Samples &samples = m_phases[phase];
+
+	Stats stats;
+	{
+		std::lock_guard lock(samples.mutex);
+		stats.samplesAmount = samples.amount;
+		// Until the ring is full the oldest sample is at 0
+		const size_t oldest = samples.amount < k_samplesAmount ? 0 : samples.next;
+		for ( size_t i = 0; i < samples.amount; ++i )
+		{
+			stats.history[i] = samples.values[( oldest + i ) % k_samplesAmount];
+		}
+	}
+
+	if ( stats.samplesAmount == 0 )
+	{
+		return stats;
+	}
+
+	const auto begin = stats.history.begin();
+	const auto end   = begin + static_cast<std::ptrdiff_t>(stats.samplesAmount);
+	stats.last = *( end - 1 );
+
+	std::array<float, k_samplesAmount> sorted{};
+	std::copy(begin, end, sorted.begin());
+	std::sort(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(stats.samplesAmount));
+
+	float sum = 0;
+	for ( size_t i = 0; i < stats.samplesAmount; ++i )
+	{
+		sum += sorted[i];
+	}
+
+	const auto p99Index = static_cast<size_t>(std::ceil(0.99 * static_cast<double>(stats.samplesAmount))) - 1;
+	stats.min = sorted[0];
+	stats.avg = sum / static_cast<float>(stats.samplesAmount);
+	stats.p99 = sorted[p99Index];
+
+	return stats;
+}
+
+void Profiler::Clear()
+{
+	for ( Samples &samples: m_phases )
+	{
+		std::lock_guard lock(samples.mutex);
+		samples.next   = 0;
+		samples.amount = 0;
+	}
+}
@@ -0,0 +1,105 @@
+#ifndef ANTS_PROFILER_HPP
+#define ANTS_PROFILER_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+#include "Tracer.hpp"
+
+/* Rolling timings of phases of a tick and of a frame, the last k_samplesAmount samples of every phase.
+ * Phases nest: Tick contains the other simulation phases, Frame contains the render ones.
+ * Tick phases are recorded by the simulation thread, frame phases by the render thread,
+ * which also reads the stats, and checkpoint writes by the thread of the Checkpointer,
+ * so samples of every phase are guarded by their own mutex */
+class Profiler
+{
+public:
+	enum Phase
+	{
+		Tick, Evaporation, AntsUpdate, Food, PostUpdate, PheromoneColors, TileMapUpdate, BrushPaint, Snapshot,
+		CheckpointCapture, CheckpointWrite,
+		Frame, TextureUpload, Draw, Gui,
+		PhasesAmount
+	};
+
+	static constexpr size_t k_samplesAmount = 240;
+
+	// In milliseconds
+	struct Stats
+	{
+		size_t samplesAmount = 0;
+
+		float last = 0;
+		float min  = 0;
+		float avg  = 0;
+		float p99  = 0;
+
+		// Oldest sample first, only first samplesAmount are valid
+		std::array<float, k_samplesAmount> history{};
+	};
+
+	static Profiler &Instance();
+	static const char *GetPhaseName(Phase phase);
+
+	// Disabled profiler doesn't record, scopes only check this flag
+	void SetEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+	bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+	void Record(Phase phase, double milliseconds);
+	Stats GetStats(Phase phase) const;
+	void Clear();
+
+private:
+	struct Samples
+	{
+		mutable std::mutex                 mutex;
+		std::array<float, k_samplesAmount> values{};
+		// Ring of values, next is overwritten first
+		size_t                             next   = 0;
+		size_t                             amount = 0;
+	};
+
+	std::array<Samples, PhasesAmount> m_phases;
+	std::atomic<bool>                 m_enabled{false};
+};
+
+// Records time from construction to destruction as a sample of the phase,
+// while tracing also as an event named after the phase
+class ProfileScope
+{
+	using Clock = std::chrono::steady_clock;
+
+public:
+	explicit ProfileScope(Profiler::Phase phase) :
+			m_phase(phase), m_enabled(Profiler::Instance().IsEnabled()), m_traceScope(Profiler::GetPhaseName(phase))
+	{
+		if ( m_enabled )
+		{
+			m_start = Clock::now();
+		}
+	}
+
+	~ProfileScope()
+	{
+		if ( m_enabled )
+		{
+			Profiler::Instance().Record(m_phase,
+			                            std::chrono::duration<double, std::milli>(Clock::now() - m_start).count());
+		}
+	}
+
+	ProfileScope(const ProfileScope &) = delete;
+	ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+	Profiler::Phase   m_phase;
+	bool              m_enabled;
+	Clock::time_point m_start;
+
+	TraceScope m_traceScope;
+};
+
+#endif //ANTS_PROFILER_HPP
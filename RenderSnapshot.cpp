@@ -0,0 +1,57 @@
+#include "RenderSnapshot.hpp"
+
+#include <algorithm>
+
+#include "AntColony.hpp"
+#include "Settings.hpp"
+
+void RenderSnapshot::Layer::Write(const ColorMap &colorMap, ColorMap::Changes &missing)
+{
+	changes = colorMap.GetChanges();
+
+	const Color *source = colorMap.GetColors();
+	if ( width != colorMap.GetWidth() || height != colorMap.GetHeight())
+	{
+		width  = colorMap.GetWidth();
+		height = colorMap.GetHeight();
+		colors.assign(source, source + static_cast<size_t>(width) * height);
+		missing.Clear();
+		return;
+	}
+
+	if ( !missing.rows.IsEmpty())
+	{
+		std::copy(source + static_cast<size_t>(missing.rows.begin) * width,
+		          source + static_cast<size_t>(missing.rows.end) * width,
+		          colors.begin() + static_cast<ptrdiff_t>(missing.rows.begin) * width);
+	}
+	for ( const auto &pixel: missing.pixels )
+	{
+		const size_t index = static_cast<size_t>(pixel.y) * width + pixel.x;
+		colors[index] = source[index];
+	}
+	missing.Clear();
+}
+
+void RenderSnapshot::Colony::WriteAnts(const AntColony &colony)
+{
+	const AntsData &ants       = colony.GetAnts();
+	const size_t   antsAmount = colony.GetAntsAmount();
+
+	// Resizing never shrinks capacity, so amount of ants may go down and up without allocating
+	posX.resize(antsAmount);
+	posY.resize(antsAmount);
+	rotation.resize(antsAmount);
+	colors.resize(antsAmount);
+
+	const auto  &antsSettings = Settings::Instance().GetAntsSettings();
+	const Color antColors[2]  = {antsSettings.antDefaultColor, antsSettings.antWithFoodColor};
+
+	std::copy(ants.posX.begin(), ants.posX.begin() + antsAmount, posX.begin());
+	std::copy(ants.posY.begin(), ants.posY.begin() + antsAmount, posY.begin());
+	std::copy(ants.rotation.begin(), ants.rotation.begin() + antsAmount, rotation.begin());
+	for ( size_t i = 0; i < antsAmount; ++i )
+	{
+		colors[i] = antColors[( ants.flags[i] & AntsData::GotFood ) != 0];
+	}
+}
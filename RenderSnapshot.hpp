@@ -0,0 +1,59 @@
+#ifndef ANTS_RENDERSNAPSHOT_HPP
+#define ANTS_RENDERSNAPSHOT_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "ColorMap.hpp"
+#include "BinaryAngle.hpp"
+
+class AntColony;
+
+/* Everything the render thread needs to draw one state of the simulation.
+ * It's written by the simulation thread and published by SimulationThread, once published
+ * it isn't changed until the render thread takes a newer one. Buffers only grow, so after
+ * a few snapshots writing them doesn't allocate */
+struct RenderSnapshot
+{
+	// Copy of a ColorMap and what changed since the previous snapshot
+	struct Layer
+	{
+		int                width  = 0;
+		int                height = 0;
+		std::vector<Color> colors;
+		ColorMap::Changes  changes;
+
+		bool IsEmpty() const { return colors.empty(); }
+
+		/* Colors of a snapshot buffer are behind the map by changes of every snapshot written
+		 * since this buffer was written the last time, 'missing' holds them and only they are copied.
+		 * Whole map is copied when its size differs, e.g. after the world was reset */
+		void Write(const ColorMap &colorMap, ColorMap::Changes &missing);
+	};
+
+	struct Colony
+	{
+		bool  largePopulation = false;
+		Layer density;
+
+		// Single ants, filled only when population isn't large
+		std::vector<float> posX;
+		std::vector<float> posY;
+		std::vector<Angle> rotation;
+		std::vector<Color> colors;
+
+		void WriteAnts(const AntColony &colony);
+	};
+
+	// Increases with every published snapshot
+	uint64_t sequence = 0;
+
+	uint64_t tick                = 0;
+	double   antUpdatesPerSecond = 0;
+
+	Layer               tiles;
+	Layer               pheromones;
+	std::vector<Colony> colonies;
+};
+
+#endif //ANTS_RENDERSNAPSHOT_HPP
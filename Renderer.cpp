@@ -0,0 +1,98 @@
+#include "Renderer.hpp"
+
+#include "BinaryAngle.hpp"
+#include "Profiler.hpp"
+
+#include <rlgl.h>
+
+void Renderer::Sync(const RenderSnapshot &snapshot)
+{
+	if ( snapshot.sequence == m_syncedSequence )
+	{
+		return;
+	}
+	m_syncedSequence = snapshot.sequence;
+
+	ProfileScope profileScope(Profiler::TextureUpload);
+
+	// Changes are uploaded even if layers aren't drawn, textures have to see every snapshot
+	m_tileMapTexture.Sync(snapshot.tiles);
+	m_pheromonesTexture.Sync(snapshot.pheromones);
+
+	if ( m_densityTextures.size() < snapshot.colonies.size())
+	{
+		m_densityTextures.resize(snapshot.colonies.size());
+	}
+	for ( size_t i = 0; i < snapshot.colonies.size(); ++i )
+	{
+		if ( !snapshot.colonies[i].largePopulation )
+		{
+			continue;
+		}
+
+		if ( !m_densityTextures[i] )
+		{
+			m_densityTextures[i] = std::make_unique<ColorMapTexture>();
+		}
+		m_densityTextures[i]->Sync(snapshot.colonies[i].density);
+	}
+}
+
+void Renderer::DrawWorld(const RenderSnapshot &snapshot) const
+{
+	const int width  = snapshot.tiles.width;
+	const int height = snapshot.tiles.height;
+
+	DrawRectangle(-5, -5, ( width + 10 ), ( height + 10 ), RED);
+	DrawRectangle(0, 0, width, height, BLACK);
+
+	m_tileMapTexture.Draw();
+}
+
+void Renderer::DrawPheromones() const
+{
+	m_pheromonesTexture.Draw();
+}
+
+void Renderer::DrawAnts(const RenderSnapshot &snapshot, size_t colonyIndex) const
+{
+	const RenderSnapshot::Colony &colony = snapshot.colonies[colonyIndex];
+	if ( colony.largePopulation )
+	{
+		m_densityTextures[colonyIndex]->Draw();
+		return;
+	}
+
+	constexpr float halfLength = 1.25f;
+	constexpr float halfWidth  = 0.625f;
+
+	// Same quads as DrawRectanglePro gives, but rotated with BinaryAngle table and sent in one batch
+	rlBegin(RL_TRIANGLES);
+	for ( size_t i = 0; i < colony.posX.size(); ++i )
+	{
+		const Color color = colony.colors[i];
+
+		const float cosValue = BinaryAngle::Cos(colony.rotation[i]);
+		const float sinValue = BinaryAngle::Sin(colony.rotation[i]);
+
+		const Vector2 along  = {halfLength * cosValue, halfLength * sinValue};
+		const Vector2 across = {-halfWidth * sinValue, halfWidth * cosValue};
+		const Vector2 pos    = {colony.posX[i], colony.posY[i]};
+
+		const Vector2 topLeft     = {pos.x - along.x - across.x, pos.y - along.y - across.y};
+		const Vector2 topRight    = {pos.x + along.x - across.x, pos.y + along.y - across.y};
+		const Vector2 bottomLeft  = {pos.x - along.x + across.x, pos.y - along.y + across.y};
+		const Vector2 bottomRight = {pos.x + along.x + across.x, pos.y + along.y + across.y};
+
+		rlColor4ub(color.r, color.g, color.b, color.a);
+
+		rlVertex2f(topLeft.x, topLeft.y);
+		rlVertex2f(bottomLeft.x, bottomLeft.y);
+		rlVertex2f(topRight.x, topRight.y);
+
+		rlVertex2f(topRight.x, topRight.y);
+		rlVertex2f(bottomLeft.x, bottomLeft.y);
+		rlVertex2f(bottomRight.x, bottomRight.y);
+	}
+	rlEnd();
+}
@@ -0,0 +1,30 @@
+#ifndef ANTS_RENDERER_HPP
+#define ANTS_RENDERER_HPP
+
+#include <memory>
+#include <vector>
+
+#include "ColorMapTexture.hpp"
+#include "RenderSnapshot.hpp"
+
+// Draws snapshots of the simulation with raylib, the simulation core knows nothing about windows and textures
+class Renderer
+{
+public:
+	// Uploads changes of a snapshot to textures, only the first call for every snapshot does something
+	void Sync(const RenderSnapshot &snapshot);
+
+	void DrawWorld(const RenderSnapshot &snapshot) const;
+	void DrawPheromones() const;
+	void DrawAnts(const RenderSnapshot &snapshot, size_t colonyIndex) const;
+
+private:
+	uint64_t m_syncedSequence = 0;
+
+	ColorMapTexture m_tileMapTexture;
+	ColorMapTexture m_pheromonesTexture;
+	// Indexed by colony
+	std::vector<std::unique_ptr<ColorMapTexture>> m_densityTextures;
+};
+
+#endif //ANTS_RENDERER_HPP
@@ -9,7 +9,12 @@ using json = nlohmann::json;
 void Settings::Save(const std::string &filename)
 {
 	std::ofstream f(filename + ".json");
-	json          j;
+	f << std::setw(4) << ToJson() << std::endl;
+}
+
+json Settings::ToJson() const
+{
+	json j;
 
 	j["Ants"]            = m_antsSettings;
 	j["AntColony"]       = m_antColonySettings;
@@ -18,33 +23,45 @@ void Settings::Save(const std::string &filename)
 	j["TileMap"]         = m_tileMapSettings;
 	j["WorldGeneration"] = m_worldGenerationSettings;
 
-	f << std::setw(4) << j << std::endl;
+	return j;
 }
 
-void Settings::Load(const std::string &filename)
+void Settings::FromJson(const json &data)
+{
+	AntsSettings            antsSettings            = data.at("Ants");
+	AntColonySettings       antColonySettings       = data.at("AntColony");
+	GlobalSettings          globalSettings          = data.at("Global");
+	PheromoneMapSettings    pheromoneMapSettings    = data.at("PheromoneMap");
+	TileMapSettings         tileMapSettings         = data.at("TileMap");
+	WorldGenerationSettings worldGenerationSettings = data.at("WorldGeneration");
+
+	m_antsSettings            = antsSettings;
+	m_antColonySettings       = antColonySettings;
+	m_globalSettings          = globalSettings;
+	m_pheromoneMapSettings    = pheromoneMapSettings;
+	m_tileMapSettings         = tileMapSettings;
+	m_worldGenerationSettings = worldGenerationSettings;
+}
+
+bool Settings::Load(const std::string &filename)
 {
 	std::ifstream f(filename);
-	json          data;
 	try
 	{
-		data = json::parse(f);
+		const json data = json::parse(f);
+
+		std::cout << std::setw(4) << data << std::endl;
+
+		FromJson(data);
 	}
 	catch ( const json::exception &e )
 	{
 		std::cout << e.what() << std::endl;
-		return;
+		return false;
 	}
 
-	std::cout << std::setw(4) << data << std::endl;
-
-	m_antsSettings            = data["Ants"];
-	m_antColonySettings       = data["AntColony"];
-	m_globalSettings          = data["Global"];
-	m_pheromoneMapSettings    = data["PheromoneMap"];
-	m_tileMapSettings         = data["TileMap"];
-	m_worldGenerationSettings = data["WorldGeneration"];
-
 //	m_globalSettings.Recalculate();
+	return true;
 }
 
 std::vector<std::string> Settings::FindSavedSettings()
@@ -55,7 +55,9 @@ NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(AntColonySettings,
                                    dynamicLife,
                                    antDeathDelay,
                                    foodToSpawnAnt,
-                                   nestSize)
+                                   nestSize,
+                                   antsSortInterval,
+                                   largePopulation)
 
 // Maybe MapSettings is better naming?
 struct GlobalSettings
@@ -129,15 +131,38 @@ NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(WorldGenerationSettings,
 class Settings
 {
 	inline static Settings *m_instance;
+	// Set by ThreadOverride
+	inline static thread_local const Settings *m_threadInstance = nullptr;
 
 public:
+	// Default-constructed settings become the instance, there is only one of them, copies don't replace it
 	Settings()
 	{
-		assert(m_instance);
+		assert(!m_instance);
 		m_instance = this;
 	}
 
-	static const Settings &Instance() { return *m_instance; }
+	static const Settings &Instance() { return m_threadInstance ? *m_threadInstance : *m_instance; }
+
+	/* While it lives, Instance returns the given settings on the calling thread,
+	 * so simulations with different settings may run at once, each on its own thread */
+	class ThreadOverride
+	{
+	public:
+		explicit ThreadOverride(const Settings &settings) :
+				m_previous(m_threadInstance)
+		{
+			m_threadInstance = &settings;
+		}
+
+		~ThreadOverride() { m_threadInstance = m_previous; }
+
+		ThreadOverride(const ThreadOverride &) = delete;
+		ThreadOverride &operator=(const ThreadOverride &) = delete;
+
+	private:
+		const Settings *m_previous;
+	};
 
 	// clang-format off
 	const AntsSettings              &GetAntsSettings()              const { return m_antsSettings; };
@@ -155,8 +180,15 @@ public:
 	WorldGenerationSettings &GetWorldGenerationSettings() { return m_worldGenerationSettings; };
 	// clang-format on
 
+	// In the format of saved settings, a section per group of settings
+	nlohmann::json ToJson() const;
+	// Throws nlohmann::json::exception when any of the settings is missing or has a wrong type,
+	// settings stay unchanged then
+	void FromJson(const nlohmann::json &data);
+
 	void Save(const std::string &filename);
-	void Load(const std::string &filename);
+	// Settings stay unchanged if the file can't be parsed or misses any of them
+	bool Load(const std::string &filename);
 
 	static std::vector<std::string> FindSavedSettings();
 
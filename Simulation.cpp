@@ -1,4 +1,5 @@
 #include <string>
+#include <iostream>
 
 #include <raylib.h>
 #include <raymath.h>
@@ -7,17 +8,12 @@
 
 #include "Simulation.hpp"
 #include "Gui.hpp"
+#include "Profiler.hpp"
 
 const int k_screenWidth  = 1280;
 const int k_screenHeight = 720;
 
-const float k_adaptiveSpeedStep = 0.005f;
-
-const int k_fpsLowThreshold  = 30;
-const int k_fpsHighThreshold = 120;
-
-constexpr float k_fixedTimestep = ( 1000.0 / 60.0 ) / 1000.0;
-
+constexpr float k_millisecond = 0.001f;
 
 Simulation::Simulation() :
 		m_settings(), m_camera()
@@ -28,8 +24,7 @@ Simulation::Simulation() :
 
 	ResetCamera();
 
-	m_world           = std::make_unique<World>();
-	m_coloniesManager = std::make_unique<ColoniesManager>(m_world->GetTileMap());
+	m_simulationThread = std::make_unique<SimulationThread>(m_settings);
 }
 
 Simulation::~Simulation()
@@ -41,21 +36,20 @@ Simulation::~Simulation()
 
 void Simulation::Start()
 {
-	float delta = 0;
 	while ( !WindowShouldClose())
 	{
-		Draw();
-		HandleInput();
-		if ( !m_pause )
-		{
-			delta += GetFrameTime() * m_gameSpeed;
+		ProfileScope profileScope(Profiler::Frame);
 
-			while ( delta >= k_fixedTimestep )
-			{
-				delta -= k_fixedTimestep;
-				Update();
-			}
+		// Snapshot stays the same until the next frame, no matter how many ticks are done meanwhile
+		const RenderSnapshot *snapshot = m_simulationThread->AcquireSnapshot();
+		if ( snapshot )
+		{
+			m_renderer.Sync(*snapshot);
 		}
+
+		Draw(snapshot);
+		HandleInput();
+		Update();
 	}
 }
 
@@ -111,7 +105,7 @@ void Simulation::HandleInput()
 	{
 		IntVec2 pos = {mouseWorldPos.x, mouseWorldPos.y};//m_settings.GetGlobalSettings().ScreenToWorld(mouseWorldPos);
 
-		m_brush.Paint(m_world->GetTileMap(), pos.x, pos.y);
+		m_simulationThread->Paint(m_brush, pos.x, pos.y);
 	}
 
 	if ( IsKeyPressed(KEY_SPACE))
@@ -165,47 +159,51 @@ void Simulation::HandleInput()
 
 void Simulation::Update()
 {
-	SetWindowTitle(( "Ants FPS:" + std::to_string(GetFPS())).c_str());
-
-	if ( m_adaptiveSpeed )
+	// Phases are timed only while somebody looks at them
+	Profiler::Instance().SetEnabled(m_showProfiler);
+
+	m_simulationThread->SetSpeed(m_gameSpeed);
+	m_simulationThread->SetPaused(m_pause);
+	// Without adaptive speed only the amount of ticks per frame is limited
+	m_simulationThread->SetTickBudget(m_adaptiveSpeed ? m_tickBudget * k_millisecond : 0);
+	// While a checkpoint loads edited settings would overwrite the loaded ones, they are taken back afterwards
+	if ( !m_simulationThread->IsLoadingCheckpoint())
 	{
-		const int fps = GetFPS();
-		if ( fps < k_fpsLowThreshold )
-		{
-			m_gameSpeed = std::max(m_gameSpeed - k_adaptiveSpeedStep, k_minGameSpeed);
-		}
-
-		if ( fps > k_fpsHighThreshold )
-		{
-			m_gameSpeed = std::min(m_gameSpeed + k_adaptiveSpeedStep, k_maxGameSpeed);
-		}
+		m_simulationThread->TakeLoadedSettings(m_editedSettings);
+		m_simulationThread->ApplySettings(m_editedSettings);
 	}
+}
+
+void Simulation::Draw(const RenderSnapshot *snapshot)
+{
+	ProfileScope profileScope(Profiler::Draw);
 
-	for ( auto &colony: m_coloniesManager->GetColonies())
+	if ( snapshot )
 	{
-		colony->Update(m_world->GetTileMap());
+		SetWindowTitle(( "Ants FPS:" + std::to_string(GetFPS()) + " ant updates/s:" +
+		                 std::to_string(static_cast<long long>(snapshot->antUpdatesPerSecond)) + " speed:" +
+		                 TextFormat("%.2f/%.2f", m_simulationThread->GetAchievedSpeed(),
+		                            m_pause ? 0.f : m_gameSpeed)).c_str());
 	}
-}
 
-void Simulation::Draw()
-{
 	BeginDrawing();
 
 	ClearBackground({64, 64, 64, 255});
 
 	BeginMode2D(m_camera);
+	if ( snapshot )
 	{
-		m_world->Draw();
+		m_renderer.DrawWorld(*snapshot);
 
-		for ( auto &colony: m_coloniesManager->GetColonies())
+		if ( m_drawPheromones )
 		{
-			if ( m_drawPheromones )
-			{
-				colony->DrawPheromones();
-			}
-			if ( m_drawAnts )
+			m_renderer.DrawPheromones();
+		}
+		if ( m_drawAnts )
+		{
+			for ( size_t i = 0; i < snapshot->colonies.size(); ++i )
 			{
-				colony->DrawAnts();
+				m_renderer.DrawAnts(*snapshot, i);
 			}
 		}
 	}
@@ -218,8 +216,8 @@ void Simulation::Draw()
 
 void Simulation::ResetCamera()
 {
-	float width  = static_cast<float>(m_settings.GetGlobalSettings().mapWidth);
-	float height = static_cast<float>(m_settings.GetGlobalSettings().mapHeight);
+	float width  = static_cast<float>(m_editedSettings.GetGlobalSettings().mapWidth);
+	float height = static_cast<float>(m_editedSettings.GetGlobalSettings().mapHeight);
 
 	m_camera.rotation = 0;
 	m_camera.zoom     = 1;
@@ -236,13 +234,20 @@ void Simulation::ShowGui()
 
 	m_shouldHandleInput = m_gui.ShouldHandleInput();
 
+	ProfileScope profileScope(Profiler::Gui);
+
 	rlImGuiBegin();
 
 	m_gui.ShowMainSettings(*this);
 
 	if ( m_showAdvancedSettings )
 	{
-		m_gui.ShowAdvancedSettings(m_settings);
+		m_gui.ShowAdvancedSettings(m_editedSettings);
+	}
+
+	if ( m_showProfiler )
+	{
+		m_gui.ShowProfiler();
 	}
 
 	rlImGuiEnd();
@@ -250,7 +255,33 @@ void Simulation::ShowGui()
 
 void Simulation::Reset()
 {
-	m_world           = std::make_unique<World>();
-	m_coloniesManager = std::make_unique<ColoniesManager>(m_world->GetTileMap());
+	m_simulationThread->Reset();
 	ResetCamera();
 }
+
+bool Simulation::LoadWorldFromImage(const std::string &imageName)
+{
+	Image image = LoadImage(imageName.c_str());
+	if ( image.data == nullptr )
+	{
+		std::cout << "Image is null" << std::endl;
+		return false;
+	}
+	Color *colors = LoadImageColors(image);
+	if ( colors == nullptr )
+	{
+		std::cout << "Colors is null" << std::endl;
+		UnloadImage(image);
+		return false;
+	}
+
+	// World is loaded by the simulation thread, edited settings get the new map size right away,
+	// so applying them later doesn't bring the old one back
+	m_editedSettings.GetGlobalSettings().mapWidth  = image.width;
+	m_editedSettings.GetGlobalSettings().mapHeight = image.height;
+	m_simulationThread->LoadWorld({colors, colors + image.width * image.height}, image.width, image.height);
+
+	UnloadImage(image);
+	UnloadImageColors(colors);
+	return true;
+}
@@ -1,11 +1,11 @@
 #ifndef ANTS_SIMULATION_HPP
 #define ANTS_SIMULATION_HPP
 
-#include "ColoniesManager.hpp"
-#include "World.hpp"
 #include "Settings.hpp"
 #include "Brush.hpp"
 #include "Gui.hpp"
+#include "Renderer.hpp"
+#include "SimulationThread.hpp"
 
 #include <string>
 
@@ -18,6 +18,9 @@ class Simulation
 	const float k_minGameSpeed = 0.1f;
 	const float k_maxGameSpeed = 30.f;
 
+	const float k_minTickBudget = 1.f;
+	const float k_maxTickBudget = 16.f;
+
 public:
 	Simulation();
 	~Simulation();
@@ -26,22 +29,31 @@ public:
 
 private:
 	void HandleInput();
+	// Hands speed and settings over to the simulation thread, once per frame
 	void Update();
-	void Draw();
+	void Draw(const RenderSnapshot *snapshot);
 
 	void ResetCamera();
 
 	void ShowGui();
 
 	void Reset();
+
+	// Decodes the image with raylib, world is built from its colors by World::LoadWorldFromColors
+	bool LoadWorldFromImage(const std::string &imageName);
 private:
+	// Read by the simulation thread, render thread edits a copy of them which is applied between ticks
 	Settings m_settings;
+	Settings m_editedSettings{m_settings};
 	Gui m_gui;
+	Renderer m_renderer;
 
-	std::unique_ptr<World> m_world;
-	std::unique_ptr<ColoniesManager> m_coloniesManager;
+	std::unique_ptr<SimulationThread> m_simulationThread;
 
 	float m_gameSpeed = 1;
+	// Milliseconds of ticking per frame with adaptive speed, speed drops below the requested one
+	// when ticks don't fit into it
+	float m_tickBudget = 8;
 
 	Camera2D m_camera{};
 
@@ -58,8 +70,11 @@ private:
 
 	bool m_showGui = true;
 	bool m_showAdvancedSettings = false;
+	bool m_showProfiler = false;
 
-	std::string m_saveFilename = "save";
+	// Checkpoint of the whole simulation, see Checkpoint, it's saved every interval ticks when the interval isn't 0
+	std::string m_saveFilename     = "save.ckpt";
+	int         m_autosaveInterval = 0;
 };
 
 
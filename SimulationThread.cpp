@@ -0,0 +1,302 @@
+#include "SimulationThread.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include "Profiler.hpp"
+
+// Simulation thread never sleeps longer, so commands and speed changes are picked up quickly
+constexpr double k_maxSleep = 0.002;
+
+void WriteLayer(ColorMap &colorMap, RenderSnapshot::Layer &layer, std::array<ColorMap::Changes, 2> &missing,
+                size_t buffer)
+{
+	for ( auto &bufferMissing: missing )
+	{
+		bufferMissing.Merge(colorMap.GetChanges());
+	}
+	layer.Write(colorMap, missing[buffer]);
+	colorMap.ClearChanges();
+}
+
+SimulationThread::SimulationThread(Settings &settings) :
+		m_settings(settings),
+		m_worldSettings(settings),
+		m_checkpointer([this](uint64_t tick, const std::string &filename, bool written, double stall, double seconds)
+		               {
+			               char times[96];
+			               std::snprintf(times, sizeof(times), " in %.3f s, simulation stopped for %.3f ms", seconds,
+			                             stall);
+
+			               std::lock_guard lock(m_checkpointMutex);
+			               m_checkpointStatus = written ? "Tick " + std::to_string(tick) + " saved to " + filename + times :
+			                                    "Can't write " + filename;
+		               })
+{
+	m_world           = std::make_unique<World>();
+	m_coloniesManager = std::make_unique<ColoniesManager>(m_world->GetTileMap());
+
+	m_thread = std::thread(&SimulationThread::Run, this);
+}
+
+SimulationThread::~SimulationThread()
+{
+	m_stop.store(true, std::memory_order_relaxed);
+	m_thread.join();
+}
+
+const RenderSnapshot *SimulationThread::AcquireSnapshot()
+{
+	const uint64_t published = m_publishedSequence.load(std::memory_order_acquire);
+	if ( published == 0 )
+	{
+		return nullptr;
+	}
+
+	// From now on the other buffer is free for the simulation thread
+	m_takenSequence.store(published, std::memory_order_release);
+	return &m_snapshots[published % 2];
+}
+
+void SimulationThread::ApplySettings(const Settings &settings)
+{
+	Post([this, settings]()
+	     {
+		     m_settings = settings;
+	     });
+}
+
+void SimulationThread::Paint(const Brush &brush, int x, int y)
+{
+	Post([this, paintBrush = brush, x, y]() mutable
+	     {
+		     paintBrush.Paint(m_world->GetTileMap(), x, y);
+		     m_changed = true;
+	     });
+}
+
+void SimulationThread::ClearMap()
+{
+	Post([this]()
+	     {
+		     m_world->ClearMap();
+		     m_changed = true;
+	     });
+}
+
+void SimulationThread::Reset()
+{
+	Post([this]()
+	     {
+		     m_world           = std::make_unique<World>();
+		     m_coloniesManager = std::make_unique<ColoniesManager>(m_world->GetTileMap());
+		     m_worldSettings   = m_settings;
+		     m_changed         = true;
+	     });
+}
+
+void SimulationThread::LoadWorld(std::vector<Color> colors, int width, int height)
+{
+	Post([this, colors = std::move(colors), width, height]()
+	     {
+		     if ( m_world->LoadWorldFromColors(m_settings, colors.data(), width, height))
+		     {
+			     m_coloniesManager = std::make_unique<ColoniesManager>(m_world->GetTileMap());
+			     m_worldSettings   = m_settings;
+		     }
+		     m_changed = true;
+	     });
+}
+
+void SimulationThread::SaveCheckpoint(const std::string &filename)
+{
+	Post([this, filename]()
+	     {
+		     SaveCheckpointNow(filename);
+	     });
+}
+
+void SimulationThread::SetAutosave(const std::string &filename, uint64_t interval)
+{
+	Post([this, filename, interval]()
+	     {
+		     m_autosaveFilename = filename;
+		     m_autosaveInterval = interval;
+	     });
+}
+
+void SimulationThread::LoadCheckpoint(const std::string &filename)
+{
+	m_loadingCheckpoint.store(true, std::memory_order_relaxed);
+	Post([this, filename]()
+	     {
+		     const std::string error = Checkpoint::Load(filename, m_settings, m_world, m_coloniesManager, m_tick);
+		     if ( error.empty())
+		     {
+			     m_worldSettings = m_settings;
+		     }
+		     m_changed = true;
+
+		     {
+			     std::lock_guard lock(m_checkpointMutex);
+			     m_checkpointStatus = error.empty() ? "Tick " + std::to_string(m_tick) + " loaded from " + filename :
+			                          "Can't load " + filename + ": " + error;
+			     m_loadedSettings   = m_settings;
+		     }
+		     m_loadingCheckpoint.store(false, std::memory_order_release);
+	     });
+}
+
+bool SimulationThread::TakeLoadedSettings(Settings &settings)
+{
+	std::lock_guard lock(m_checkpointMutex);
+	if ( !m_loadedSettings )
+	{
+		return false;
+	}
+
+	settings = *m_loadedSettings;
+	m_loadedSettings.reset();
+	return true;
+}
+
+std::string SimulationThread::GetCheckpointStatus() const
+{
+	std::lock_guard lock(m_checkpointMutex);
+	return m_checkpointStatus;
+}
+
+void SimulationThread::Run()
+{
+	using Clock = std::chrono::steady_clock;
+
+	const auto startTime = Clock::now();
+	const auto seconds   = [](Clock::duration duration)
+	{
+		return std::chrono::duration<double>(duration).count();
+	};
+
+	while ( !m_stop.load(std::memory_order_relaxed))
+	{
+		ExecuteCommands();
+
+		m_speedController.SetRequestedSpeed(m_speed.load(std::memory_order_relaxed));
+		m_speedController.SetPaused(m_paused.load(std::memory_order_relaxed));
+		m_speedController.SetTickBudget(m_tickBudget.load(std::memory_order_relaxed));
+		m_speedController.Update(seconds(Clock::now() - startTime));
+
+		m_achievedSpeed.store(m_speedController.GetAchievedSpeed(), std::memory_order_relaxed);
+		m_tickCost.store(m_speedController.GetTickCost(), std::memory_order_relaxed);
+
+		if ( m_speedController.ShouldTick())
+		{
+			const auto tickStart = Clock::now();
+			Tick();
+			m_speedController.OnTick(seconds(Clock::now() - tickStart));
+			if ( m_autosaveInterval > 0 && m_tick % m_autosaveInterval == 0 )
+			{
+				SaveCheckpointNow(m_autosaveFilename);
+			}
+			Publish();
+			continue;
+		}
+
+		Publish();
+
+		// Sleeps until the next tick is due
+		const double sleep = std::clamp(m_speedController.GetWaitTime(), 0.0, k_maxSleep);
+		std::this_thread::sleep_for(std::chrono::duration<double>(sleep));
+	}
+}
+
+void SimulationThread::Post(std::function<void()> command)
+{
+	std::lock_guard lock(m_commandsMutex);
+	m_commands.push_back(std::move(command));
+	m_hasCommands.store(true, std::memory_order_release);
+}
+
+void SimulationThread::ExecuteCommands()
+{
+	if ( !m_hasCommands.load(std::memory_order_acquire))
+	{
+		return;
+	}
+
+	{
+		std::lock_guard lock(m_commandsMutex);
+		std::swap(m_commands, m_executedCommands);
+		m_hasCommands.store(false, std::memory_order_relaxed);
+	}
+
+	for ( auto &command: m_executedCommands )
+	{
+		command();
+	}
+	m_executedCommands.clear();
+}
+
+void SimulationThread::Tick()
+{
+	m_coloniesManager->Update(m_world->GetTileMap());
+	++m_tick;
+	m_changed = true;
+}
+
+void SimulationThread::SaveCheckpointNow(const std::string &filename)
+{
+	// Set before the capture is queued, so it can't replace the status of the finished write
+	{
+		std::lock_guard lock(m_checkpointMutex);
+		m_checkpointStatus = "Saving tick " + std::to_string(m_tick) + " to " + filename;
+	}
+	// Edited map and colonies settings aren't applied before a restart, they would make the checkpoint unloadable,
+	// settings of ants are read on every tick, so the edited ones are saved
+	Settings savedSettings = m_worldSettings;
+	savedSettings.GetAntsSettings() = m_settings.GetAntsSettings();
+	m_checkpointer.Save(filename, savedSettings, *m_world, *m_coloniesManager, m_tick);
+}
+
+void SimulationThread::Publish()
+{
+	const uint64_t published = m_publishedSequence.load(std::memory_order_relaxed);
+	if ( !m_changed || m_takenSequence.load(std::memory_order_acquire) != published )
+	{
+		return;
+	}
+
+	ProfileScope profileScope(Profiler::Snapshot);
+
+	const size_t   buffer   = ( published + 1 ) % 2;
+	RenderSnapshot &snapshot = m_snapshots[buffer];
+
+	snapshot.tick                = m_tick;
+	snapshot.antUpdatesPerSecond = m_coloniesManager->GetAntUpdatesPerSecond();
+
+	WriteLayer(m_world->GetTileMap().GetColorMap(), snapshot.tiles, m_missingTiles, buffer);
+	WriteLayer(m_coloniesManager->GetPheromoneMap().GetColorMap(), snapshot.pheromones, m_missingPheromones, buffer);
+
+	auto &colonies = m_coloniesManager->GetColonies();
+	snapshot.colonies.resize(colonies.size());
+	m_missingDensity.resize(colonies.size());
+	for ( size_t i = 0; i < colonies.size(); ++i )
+	{
+		auto &colony         = *colonies[i];
+		auto &colonySnapshot = snapshot.colonies[i];
+
+		colonySnapshot.largePopulation = colony.IsLargePopulation();
+		if ( colony.IsLargePopulation())
+		{
+			WriteLayer(*colony.GetDensityMap(), colonySnapshot.density, m_missingDensity[i], buffer);
+		}
+		else
+		{
+			colonySnapshot.WriteAnts(colony);
+		}
+	}
+
+	snapshot.sequence = published + 1;
+	m_publishedSequence.store(published + 1, std::memory_order_release);
+	m_changed = false;
+}
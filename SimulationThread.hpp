@@ -0,0 +1,147 @@
+#ifndef ANTS_SIMULATIONTHREAD_HPP
+#define ANTS_SIMULATIONTHREAD_HPP
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "World.hpp"
+#include "ColoniesManager.hpp"
+#include "Settings.hpp"
+#include "Brush.hpp"
+#include "RenderSnapshot.hpp"
+#include "SpeedController.hpp"
+#include "Checkpoint.hpp"
+#include "Checkpointer.hpp"
+
+/* Runs the simulation on its own thread, so frame rate and tick rate don't depend on each other.
+ *
+ * World and colonies are owned by the simulation thread, render thread never touches them:
+ * changes of the world are posted as commands, which are executed between ticks,
+ * and the state is drawn from snapshots.
+ *
+ * Snapshots are double-buffered without locks: a new one is written to the buffer
+ * the render thread left when it took the last one, so it's written only after the render thread
+ * has taken the previous one and every snapshot is taken. Render thread keeps reading
+ * the snapshot it took until it takes the next one */
+class SimulationThread
+{
+public:
+	// Settings have to outlive the thread, they are read by the simulation on every tick
+	explicit SimulationThread(Settings &settings);
+	~SimulationThread();
+
+	SimulationThread(const SimulationThread &) = delete;
+	SimulationThread &operator=(const SimulationThread &) = delete;
+
+	// Called by the render thread
+
+	// Latest published snapshot or nullptr if there isn't any yet,
+	// it stays unchanged until the next call
+	const RenderSnapshot *AcquireSnapshot();
+
+	// Simulated seconds per real second
+	void SetSpeed(float speed) { m_speed.store(speed, std::memory_order_relaxed); }
+	void SetPaused(bool paused) { m_paused.store(paused, std::memory_order_relaxed); }
+	// Real seconds of ticking allowed per frame, 0 means unlimited, see SpeedController
+	void SetTickBudget(double budget) { m_tickBudget.store(budget, std::memory_order_relaxed); }
+
+	// Simulated seconds per real second the simulation keeps up with, at most the requested speed
+	float GetAchievedSpeed() const { return m_achievedSpeed.load(std::memory_order_relaxed); }
+	// Average real seconds a tick takes
+	double GetTickCost() const { return m_tickCost.load(std::memory_order_relaxed); }
+
+	// Commands are executed by the simulation thread in order of posting, between ticks.
+	// Settings edited by the render thread are copied to the ones read by the simulation
+	void ApplySettings(const Settings &settings);
+	void Paint(const Brush &brush, int x, int y);
+	void ClearMap();
+	void Reset();
+	// Map size is taken from width and height, world is built by World::LoadWorldFromColors
+	void LoadWorld(std::vector<Color> colors, int width, int height);
+	// Full state is captured between ticks and written while the simulation goes on, see Checkpointer
+	void SaveCheckpoint(const std::string &filename);
+	// Saves a checkpoint every interval ticks, 0 turns autosaving off
+	void SetAutosave(const std::string &filename, uint64_t interval);
+	// Settings are replaced by the saved ones, edited settings are taken back by TakeLoadedSettings
+	// and shouldn't be applied while the checkpoint is loading, they would overwrite the loaded ones
+	void LoadCheckpoint(const std::string &filename);
+
+	bool IsLoadingCheckpoint() const { return m_loadingCheckpoint.load(std::memory_order_acquire); }
+	// Settings the simulation runs with after the last loading, false if nothing was loaded since the last call
+	bool TakeLoadedSettings(Settings &settings);
+	// Result of the last saving or loading
+	std::string GetCheckpointStatus() const;
+
+private:
+	void Run();
+
+	void Post(std::function<void()> command);
+	void ExecuteCommands();
+
+	void Tick();
+
+	// Captures the state now, it is written later
+	void SaveCheckpointNow(const std::string &filename);
+
+	// Writes and publishes a snapshot if the render thread took the previous one
+	void Publish();
+
+private:
+	using MissingChanges = std::array<ColorMap::Changes, 2>;
+
+	Settings &m_settings;
+
+	std::unique_ptr<World>           m_world;
+	std::unique_ptr<ColoniesManager> m_coloniesManager;
+	// Settings the world and colonies were built with, the edited ones may differ until a restart
+	Settings                         m_worldSettings;
+
+	uint64_t m_tick = 0;
+	// World changed since the last published snapshot
+	bool     m_changed = true;
+
+	std::array<RenderSnapshot, 2> m_snapshots;
+	// Buffer of snapshot s is m_snapshots[s % 2], 0 means nothing was published yet
+	std::atomic<uint64_t>         m_publishedSequence{0};
+	std::atomic<uint64_t>         m_takenSequence{0};
+
+	// Changes every snapshot buffer misses, per buffer
+	MissingChanges              m_missingTiles;
+	MissingChanges              m_missingPheromones;
+	std::vector<MissingChanges> m_missingDensity;
+
+	std::mutex                         m_commandsMutex;
+	std::vector<std::function<void()>> m_commands;
+	std::vector<std::function<void()>> m_executedCommands;
+	std::atomic<bool>                  m_hasCommands{false};
+
+	SpeedController m_speedController;
+
+	mutable std::mutex      m_checkpointMutex;
+	std::string             m_checkpointStatus;
+	std::optional<Settings> m_loadedSettings;
+	std::atomic<bool>       m_loadingCheckpoint{false};
+	std::string             m_autosaveFilename;
+	uint64_t                m_autosaveInterval = 0;
+	// Reports to the status above from its own thread, so it's destroyed first
+	Checkpointer            m_checkpointer;
+
+	std::atomic<float>  m_speed{1.f};
+	std::atomic<bool>   m_paused{false};
+	std::atomic<double> m_tickBudget{0};
+	std::atomic<bool>   m_stop{false};
+
+	std::atomic<float>  m_achievedSpeed{0};
+	std::atomic<double> m_tickCost{0};
+
+	std::thread m_thread;
+};
+
+#endif //ANTS_SIMULATIONTHREAD_HPP
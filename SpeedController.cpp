@@ -0,0 +1,78 @@
+#include "SpeedController.hpp"
+
+#include <algorithm>
+
+// Weight of the last tick in the average cost of ticks
+constexpr double k_tickCostSmoothing = 0.1;
+
+// Achieved speed is measured over at least this many seconds
+constexpr double k_speedMeasureWindow = 0.5;
+
+void SpeedController::Update(double time)
+{
+	if ( m_time < 0 )
+	{
+		m_time         = time;
+		m_measureStart = time;
+		StartFrame(time);
+	}
+
+	if ( !m_paused )
+	{
+		m_lag += ( time - m_time ) * m_requestedSpeed;
+	}
+	m_time = time;
+
+	if ( m_time - m_frameStart >= k_frameTime )
+	{
+		// Ticks which didn't fit into the last frame are dropped, no more than a frame of ticks is carried over
+		m_lag = std::min(m_lag, k_maxTicksPerFrame * k_timestep);
+		StartFrame(m_time);
+	}
+
+	if ( m_time - m_measureStart >= k_speedMeasureWindow )
+	{
+		m_achievedSpeed = static_cast<float>(m_measuredTicks * k_timestep / ( m_time - m_measureStart ));
+		m_measuredTicks = 0;
+		m_measureStart  = m_time;
+	}
+}
+
+bool SpeedController::ShouldTick() const
+{
+	if ( m_lag < k_timestep || m_frameTicks >= k_maxTicksPerFrame )
+	{
+		return false;
+	}
+
+	return m_tickBudget <= 0 || m_frameTickTime < m_tickBudget;
+}
+
+double SpeedController::GetWaitTime() const
+{
+	const double frameLeft = m_frameStart + k_frameTime - m_time;
+	if ( m_paused || m_requestedSpeed <= 0 || m_lag >= k_timestep )
+	{
+		// Either nothing to tick or the frame is over its limits, waiting for the next one
+		return frameLeft;
+	}
+
+	return std::min(( k_timestep - m_lag ) / m_requestedSpeed, frameLeft);
+}
+
+void SpeedController::OnTick(double cost)
+{
+	m_lag -= k_timestep;
+	++m_frameTicks;
+	m_frameTickTime += cost;
+	++m_measuredTicks;
+
+	m_tickCost = m_tickCost > 0 ? m_tickCost + ( cost - m_tickCost ) * k_tickCostSmoothing : cost;
+}
+
+void SpeedController::StartFrame(double time)
+{
+	m_frameStart    = time;
+	m_frameTicks    = 0;
+	m_frameTickTime = 0;
+}
@@ -0,0 +1,61 @@
+#ifndef ANTS_SPEEDCONTROLLER_HPP
+#define ANTS_SPEEDCONTROLLER_HPP
+
+/* Decides when the simulation thread ticks.
+ *
+ * Simulated time advances by real time times requested speed, every tick takes a fixed step of it.
+ * Ticks are counted in frames of real time: in one frame at most k_maxTicksPerFrame ticks are done
+ * and ticking stops once their measured cost reaches the tick budget, so the rest of the frame
+ * is left to rendering. Simulated time which couldn't be caught up within these limits is dropped
+ * instead of being carried over, so under load the simulation slows down instead of
+ * spiralling into longer and longer catch-ups */
+class SpeedController
+{
+public:
+	static constexpr double k_timestep         = 1.0 / 60.0;
+	static constexpr double k_frameTime        = 1.0 / 60.0;
+	static constexpr int    k_maxTicksPerFrame = 30;
+
+	// Simulated seconds per real second
+	void SetRequestedSpeed(float speed) { m_requestedSpeed = speed; }
+	void SetPaused(bool paused) { m_paused = paused; }
+	// Seconds of ticking allowed per frame, 0 means only the amount of ticks per frame is limited
+	void SetTickBudget(double budget) { m_tickBudget = budget; }
+
+	// Advances real time, in seconds since any fixed point
+	void Update(double time);
+
+	bool ShouldTick() const;
+	// Seconds to wait until ShouldTick may change, while it returns false
+	double GetWaitTime() const;
+	void OnTick(double cost);
+
+	// Simulated seconds per real second, measured
+	float GetAchievedSpeed() const { return m_achievedSpeed; }
+	// Average real seconds a tick takes
+	double GetTickCost() const { return m_tickCost; }
+
+private:
+	void StartFrame(double time);
+
+private:
+	float  m_requestedSpeed = 1;
+	bool   m_paused         = false;
+	double m_tickBudget     = 0;
+
+	double m_time = -1;
+	// Simulated time waiting to be ticked
+	double m_lag  = 0;
+
+	double m_frameStart     = 0;
+	int    m_frameTicks     = 0;
+	double m_frameTickTime  = 0;
+
+	double m_tickCost = 0;
+
+	double m_measureStart  = 0;
+	int    m_measuredTicks = 0;
+	float  m_achievedSpeed = 0;
+};
+
+#endif //ANTS_SPEEDCONTROLLER_HPP
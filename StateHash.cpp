@@ -0,0 +1,94 @@
+#include "StateHash.hpp"
+
+#include <vector>
+
+#include "TileMap.hpp"
+#include "ColoniesManager.hpp"
+
+// 64-bit FNV-1a
+class Hasher
+{
+public:
+	void Add(const void *data, size_t size)
+	{
+		const auto *bytes = static_cast<const uint8_t *>(data);
+		for ( size_t i = 0; i < size; ++i )
+		{
+			m_hash = ( m_hash ^ bytes[i] ) * k_prime;
+		}
+	}
+
+	template<typename T>
+	void Add(const T &value) { Add(&value, sizeof(T)); }
+
+	// Only first amount elements, storage of ants is bigger than the amount of ants
+	template<typename T>
+	void Add(const std::vector<T> &values, size_t amount) { Add(values.data(), amount * sizeof(T)); }
+
+	uint64_t Get() const { return m_hash; }
+
+private:
+	static constexpr uint64_t k_offsetBasis = 14695981039346656037ULL;
+	static constexpr uint64_t k_prime       = 1099511628211ULL;
+
+	uint64_t m_hash = k_offsetBasis;
+};
+
+StateHash StateHash::Compute(const TileMap &tileMap, const ColoniesManager &coloniesManager)
+{
+	StateHash hash;
+
+	Hasher ants;
+	for ( const auto &colony: coloniesManager.GetColonies())
+	{
+		const AntsData &data   = colony->GetAnts();
+		const size_t   amount = colony->GetAntsAmount();
+
+		ants.Add(colony->GetId());
+		ants.Add(amount);
+		ants.Add(data.posX, amount);
+		ants.Add(data.posY, amount);
+		ants.Add(data.prevPosX, amount);
+		ants.Add(data.prevPosY, amount);
+		ants.Add(data.rotation, amount);
+		ants.Add(data.desiredRotation, amount);
+		ants.Add(data.pheromoneStrength, amount);
+		ants.Add(data.state, amount);
+		ants.Add(data.flags, amount);
+		for ( const auto &deadlines: data.deadlines )
+		{
+			ants.Add(deadlines, amount);
+		}
+		ants.Add(data.takenFoodPos, amount);
+		ants.Add(data.id, amount);
+	}
+	hash.ants = ants.Get();
+
+	Hasher tiles;
+	for ( int y = 0; y < tileMap.GetHeight(); ++y )
+	{
+		for ( int x = 0; x < tileMap.GetWidth(); ++x )
+		{
+			const Tile &tile = tileMap.GetTile({x, y});
+			tiles.Add(tile.GetType());
+			tiles.Add(tile.GetAmount());
+		}
+	}
+	hash.tiles = tiles.Get();
+
+	Hasher      pheromones;
+	const auto &values = coloniesManager.GetPheromoneMap().GetValues();
+	pheromones.Add(values, values.size());
+	hash.pheromones = pheromones.Get();
+
+	return hash;
+}
+
+uint64_t StateHash::Combined() const
+{
+	Hasher combined;
+	combined.Add(ants);
+	combined.Add(tiles);
+	combined.Add(pheromones);
+	return combined.Get();
+}
@@ -0,0 +1,30 @@
+#ifndef ANTS_STATEHASH_HPP
+#define ANTS_STATEHASH_HPP
+
+#include <cstdint>
+
+class TileMap;
+class ColoniesManager;
+
+/* Hashes of the whole state of the simulation: every array of ants of every colony,
+ * types and food amounts of tiles and every pheromone value. Equal hashes mean the states
+ * are equal bit for bit, so runs with different thread counts or implementations
+ * can be checked against each other and against stored goldens */
+struct StateHash
+{
+	uint64_t ants       = 0;
+	uint64_t tiles      = 0;
+	uint64_t pheromones = 0;
+
+	static StateHash Compute(const TileMap &tileMap, const ColoniesManager &coloniesManager);
+
+	uint64_t Combined() const;
+
+	bool operator==(const StateHash &other) const
+	{
+		return ants == other.ants && tiles == other.tiles && pheromones == other.pheromones;
+	}
+	bool operator!=(const StateHash &other) const { return !( *this == other ); }
+};
+
+#endif //ANTS_STATEHASH_HPP
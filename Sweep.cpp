@@ -0,0 +1,292 @@
+#include "Sweep.hpp"
+
+#include <array>
+#include <cmath>
+#include <map>
+
+#include <omp.h>
+
+#include "Experiment.hpp"
+
+using json = nlohmann::json;
+
+// Two-sided 95% critical values of Student's t distribution by degrees of freedom, normal one beyond them
+constexpr std::array<double, 30> k_tCriticalValues = {
+		12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+		2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+		2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+constexpr double                     k_normalCriticalValue = 1.96;
+
+// Range is {"from", "to", "step"}, integer ranges give integers
+bool ExpandRange(const json &range, std::vector<json> &values)
+{
+	if ( !range.contains("from") || !range.contains("to") || !range.contains("step"))
+	{
+		return false;
+	}
+
+	const json &from = range["from"];
+	const json &to   = range["to"];
+	const json &step = range["step"];
+	if ( !from.is_number() || !to.is_number() || !step.is_number() || step.get<double>() <= 0 )
+	{
+		return false;
+	}
+
+	const bool   isInteger = from.is_number_integer() && to.is_number_integer() && step.is_number_integer();
+	const double first     = from.get<double>();
+	// Tolerates rounding of the last step
+	const auto   amount    = static_cast<long>(std::floor(( to.get<double>() - first ) / step.get<double>() + 1e-9)) + 1;
+	for ( long i = 0; i < amount; ++i )
+	{
+		if ( isInteger )
+		{
+			values.emplace_back(from.get<long>() + i * step.get<long>());
+		}
+		else
+		{
+			values.emplace_back(first + static_cast<double>(i) * step.get<double>());
+		}
+	}
+
+	return !values.empty();
+}
+
+std::string Sweep::Load(const json &description, const Settings &baseSettings)
+{
+	m_parameters.clear();
+	m_combinations.clear();
+	m_combinationValues.clear();
+
+	try
+	{
+		m_ticks       = description.value("ticks", 1000L);
+		m_seedsAmount = description.value("seeds", 1);
+	}
+	catch ( const json::exception &exception )
+	{
+		return exception.what();
+	}
+	if ( m_ticks < 1 || m_seedsAmount < 1 )
+	{
+		return "ticks and seeds have to be positive";
+	}
+
+	const json baseJson   = baseSettings.ToJson();
+	const json parameters = description.value("parameters", json::object());
+	if ( !parameters.is_object())
+	{
+		return "parameters have to be an object";
+	}
+	for ( const auto &[path, values]: parameters.items())
+	{
+		Parameter parameter{path[0] == '/' ? path : "/" + path, {}};
+		try
+		{
+			if ( !baseJson.contains(json::json_pointer(parameter.path)))
+			{
+				return "no setting " + path;
+			}
+		}
+		catch ( const json::exception &exception )
+		{
+			return path + ": " + exception.what();
+		}
+
+		if ( values.is_array())
+		{
+			parameter.values.assign(values.begin(), values.end());
+		}
+		else if ( !values.is_object() || !ExpandRange(values, parameter.values))
+		{
+			return path + " has to be an array of values or {\"from\", \"to\", \"step\"}";
+		}
+		if ( parameter.values.empty())
+		{
+			return path + " has no values";
+		}
+
+		m_parameters.push_back(std::move(parameter));
+	}
+
+	// Cartesian product, the last parameter changes first
+	std::vector<size_t> indices(m_parameters.size(), 0);
+	while ( true )
+	{
+		json              combination = baseJson;
+		std::vector<json> values;
+		for ( size_t i = 0; i < m_parameters.size(); ++i )
+		{
+			values.push_back(m_parameters[i].values[indices[i]]);
+			combination[json::json_pointer(m_parameters[i].path)] = values.back();
+		}
+
+		Settings settings(baseSettings);
+		try
+		{
+			settings.FromJson(combination);
+		}
+		catch ( const json::exception &exception )
+		{
+			return std::string("values don't fit settings: ") + exception.what();
+		}
+		m_combinations.push_back(settings);
+		m_combinationValues.push_back(std::move(values));
+
+		size_t parameter = m_parameters.size();
+		while ( parameter > 0 && ++indices[parameter - 1] == m_parameters[parameter - 1].values.size())
+		{
+			indices[--parameter] = 0;
+		}
+		if ( parameter == 0 )
+		{
+			break;
+		}
+	}
+
+	return {};
+}
+
+std::vector<Sweep::Result> Sweep::Run(const std::function<void(size_t)> &onProgress) const
+{
+	const auto runsAmount = static_cast<long>(GetRunsAmount());
+
+	// Settings of every run, seeds follow the seed of the swept settings
+	std::vector<Settings> runSettings;
+	runSettings.reserve(runsAmount);
+	for ( long run = 0; run < runsAmount; ++run )
+	{
+		runSettings.push_back(m_combinations[run / m_seedsAmount]);
+		runSettings.back().GetWorldGenerationSettings().seed += static_cast<int>(run % m_seedsAmount);
+	}
+
+	// Runs with the same world settings share the generated world
+	std::map<std::string, size_t> mapIndices;
+	std::vector<size_t>           runMaps(runsAmount);
+	std::vector<long>             mapRuns;
+	for ( long run = 0; run < runsAmount; ++run )
+	{
+		const Settings &settings = runSettings[run];
+		const json     key       = {settings.GetWorldGenerationSettings(), settings.GetGlobalSettings().mapWidth,
+		                            settings.GetGlobalSettings().mapHeight};
+
+		const auto [mapIndex, isNew] = mapIndices.try_emplace(key.dump(), mapRuns.size());
+		if ( isNew )
+		{
+			mapRuns.push_back(run);
+		}
+		runMaps[run] = mapIndex->second;
+	}
+
+	// Simulations don't open parallel regions of their own, every one stays on the thread it was started on
+	const int activeLevels = omp_get_max_active_levels();
+	omp_set_max_active_levels(1);
+
+	const auto                   mapsAmount = static_cast<long>(mapRuns.size());
+	std::vector<Experiment::Map> maps(mapsAmount);
+#pragma omp parallel for schedule(dynamic, 1) default(none) shared(mapsAmount, maps, runSettings, mapRuns)
+	for ( long map = 0; map < mapsAmount; ++map )
+	{
+		const Settings           &settings = runSettings[mapRuns[map]];
+		Settings::ThreadOverride threadSettings(settings);
+		maps[map] = Experiment::GenerateMap(settings);
+	}
+
+	std::vector<RunResult> runResults(runsAmount);
+	size_t                 finishedRuns = 0;
+#pragma omp parallel for schedule(dynamic, 1) default(none) shared(runsAmount, runSettings, runMaps, maps, runResults, finishedRuns, onProgress)
+	for ( long run = 0; run < runsAmount; ++run )
+	{
+		Settings                 &settings = runSettings[run];
+		Settings::ThreadOverride threadSettings(settings);
+
+		Experiment experiment(settings, &maps[runMaps[run]]);
+		experiment.Run(m_ticks, m_ticks, [&runResults, run](const Experiment::Metrics &metrics)
+		{
+			RunResult &result = runResults[run];
+			result            = {0, 0, static_cast<double>(metrics.foodRemaining), metrics.tickMilliseconds};
+			for ( size_t colony = 0; colony < metrics.ants.size(); ++colony )
+			{
+				result.ants += static_cast<double>(metrics.ants[colony]);
+				result.foodDelivered += static_cast<double>(metrics.foodDelivered[colony]);
+			}
+		});
+
+#pragma omp critical
+		onProgress(++finishedRuns);
+	}
+
+	omp_set_max_active_levels(activeLevels);
+
+	std::vector<Result> results;
+	for ( size_t combination = 0; combination < m_combinations.size(); ++combination )
+	{
+		const auto             first = runResults.begin() + static_cast<long>(combination) * m_seedsAmount;
+		std::vector<RunResult> runs(first, first + m_seedsAmount);
+
+		Result result;
+		result.values           = m_combinationValues[combination];
+		result.foodDelivered    = Summarize(runs, &RunResult::foodDelivered);
+		result.ants             = Summarize(runs, &RunResult::ants);
+		result.foodRemaining    = Summarize(runs, &RunResult::foodRemaining);
+		result.tickMilliseconds = Summarize(runs, &RunResult::tickMilliseconds);
+		results.push_back(std::move(result));
+	}
+
+	return results;
+}
+
+void Sweep::WriteCsv(std::ostream &stream, const std::vector<Result> &results) const
+{
+	for ( const Parameter &parameter: m_parameters )
+	{
+		stream << parameter.path.substr(1) << ',';
+	}
+	stream << "seeds,food_delivered,food_delivered_ci95,ants,ants_ci95,food_remaining,food_remaining_ci95,"
+	          "tick_ms,tick_ms_ci95\n";
+
+	for ( const Result &result: results )
+	{
+		for ( const json &value: result.values )
+		{
+			stream << value.dump() << ',';
+		}
+		stream << m_seedsAmount;
+		for ( const Statistic &statistic: {result.foodDelivered, result.ants, result.foodRemaining,
+		                                   result.tickMilliseconds} )
+		{
+			stream << ',' << statistic.mean << ',' << statistic.confidence;
+		}
+		stream << '\n';
+	}
+}
+
+Sweep::Statistic Sweep::Summarize(const std::vector<RunResult> &runs, double RunResult::*metric)
+{
+	Statistic statistic;
+
+	const auto amount = static_cast<double>(runs.size());
+	for ( const RunResult &run: runs )
+	{
+		statistic.mean += run.*metric / amount;
+	}
+
+	if ( runs.size() < 2 )
+	{
+		return statistic;
+	}
+
+	double squares = 0;
+	for ( const RunResult &run: runs )
+	{
+		squares += ( run.*metric - statistic.mean ) * ( run.*metric - statistic.mean );
+	}
+
+	const size_t degreesOfFreedom = runs.size() - 1;
+	const double criticalValue    = degreesOfFreedom <= k_tCriticalValues.size() ?
+	                                k_tCriticalValues[degreesOfFreedom - 1] : k_normalCriticalValue;
+	statistic.confidence = criticalValue * std::sqrt(squares / static_cast<double>(degreesOfFreedom) / amount);
+
+	return statistic;
+}
@@ -0,0 +1,83 @@
+#ifndef ANTS_SWEEP_HPP
+#define ANTS_SWEEP_HPP
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <json.hpp>
+
+#include "Settings.hpp"
+
+/* Runs experiments for every combination of values of swept settings, every combination with several seeds.
+ *
+ * Sweep is described by JSON:
+ *   {"ticks": 2000, "seeds": 4,
+ *    "parameters": {"Ants/antFovRange": [2, 4, 6],
+ *                   "PheromoneMap/pheromoneEvaporationRate": {"from": 0.01, "to": 0.05, "step": 0.01}}}
+ * Parameters are paths into saved settings (see Settings::ToJson), any of the settings may be swept.
+ *
+ * Experiments run at once on threads of one OpenMP team, each experiment on a single thread, with its settings
+ * returned by Settings::Instance on that thread. Worlds are generated once per seed and world settings
+ * and shared by the experiments which differ only in other settings */
+class Sweep
+{
+public:
+	struct Parameter
+	{
+		std::string                 path;
+		std::vector<nlohmann::json> values;
+	};
+
+	struct Statistic
+	{
+		double mean = 0;
+		// Half-width of 95% confidence interval of the mean, 0 for a single seed
+		double confidence = 0;
+	};
+
+	struct Result
+	{
+		// Per parameter
+		std::vector<nlohmann::json> values;
+
+		Statistic foodDelivered;
+		Statistic ants;
+		Statistic foodRemaining;
+		Statistic tickMilliseconds;
+	};
+
+	// Returns an empty string if the description is valid, otherwise what is wrong with it
+	std::string Load(const nlohmann::json &description, const Settings &baseSettings);
+
+	size_t GetRunsAmount() const { return m_combinations.size() * m_seedsAmount; }
+
+	// Progress is reported after every finished run, from the thread which ran it
+	std::vector<Result> Run(const std::function<void(size_t finishedRuns)> &onProgress) const;
+
+	void WriteCsv(std::ostream &stream, const std::vector<Result> &results) const;
+
+private:
+	struct RunResult
+	{
+		double foodDelivered;
+		double ants;
+		double foodRemaining;
+		double tickMilliseconds;
+	};
+
+	static Statistic Summarize(const std::vector<RunResult> &runs, double RunResult::*metric);
+
+private:
+	long m_ticks       = 1000;
+	int  m_seedsAmount = 1;
+
+	std::vector<Parameter> m_parameters;
+	// Settings of every combination of values of parameters, seed is set per run
+	std::vector<Settings>  m_combinations;
+	// Values of parameters as described, settings may store them rounded
+	std::vector<std::vector<nlohmann::json>> m_combinationValues;
+};
+
+#endif //ANTS_SWEEP_HPP
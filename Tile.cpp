@@ -39,11 +39,11 @@ void Tile::ChangeType(TileType type, Nest *nest)
 	m_color        = settings.tileDefaultColors[static_cast<int>(m_type)];
 	m_defaultColor = m_color;
 
-	m_amount = 0;
-	m_nest   = nullptr;
+	m_amount.store(0, std::memory_order_relaxed);
+	m_nest = nullptr;
 	if ( m_type == TileType::eFood )
 	{
-		m_amount = settings.foodDefaultAmount;
+		m_amount.store(settings.foodDefaultAmount, std::memory_order_relaxed);
 	}
 	else if ( m_type == TileType::eNest )
 	{
@@ -4,6 +4,7 @@
 #include <raylib.h>
 #include <memory>
 #include <bitset>
+#include <atomic>
 
 #include "IntVec.hpp"
 
@@ -11,6 +12,9 @@ class Nest;
 
 class Tile
 {
+	// Saves and restores state which isn't exposed otherwise
+	friend class Checkpoint;
+
 public:
 	enum TileType
 	{
@@ -27,7 +31,10 @@ public:
 
 	void ChangeType(TileType type, Nest *nest = nullptr);
 
-	inline bool Take() { return --m_amount <= 0; };
+	// Takes a unit of food, may be called in parallel. Returns amount left after taking,
+	// which is negative if the tile was already emptied by others
+	inline int Claim() { return m_amount.fetch_sub(1, std::memory_order_relaxed) - 1; };
+	inline int GetAmount() const { return m_amount.load(std::memory_order_relaxed); };
 
 	inline Nest *GetNest() const { return m_nest; };
 	inline TileType GetType() const { return m_type; };
@@ -42,8 +49,8 @@ private:
 	Color m_color;
 	Color m_defaultColor;
 
-	int  m_amount;
-	Nest *m_nest;
+	std::atomic<int> m_amount;
+	Nest             *m_nest;
 };
 
 using TileType = Tile::TileType;
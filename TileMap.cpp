@@ -5,6 +5,7 @@
 #include "Brush.hpp"
 
 #include "Nest.hpp"
+#include "Profiler.hpp"
 
 const IntVec2 k_directionsPos[4] = {
 		{1,  0},
@@ -47,6 +48,7 @@ void TileMap::SetTile(const IntVec2 &pos, TileType newType)
 	for ( auto deltaPos: k_directionsPos )
 	{
 		UpdateTileColor(pos + deltaPos);
+		m_colorMap->UpdatePixel(pos + deltaPos);
 	}
 
 	UpdateColorMap(pos);
@@ -61,6 +63,8 @@ void TileMap::UnsafeSetTile(int x, int y, TileType newType)
 
 void TileMap::Update()
 {
+	ProfileScope profileScope(Profiler::TileMapUpdate);
+
 #pragma omp parallel for collapse(2) default(none)
 	for ( int y = 0; y < m_height; ++y )
 	{
@@ -73,19 +77,34 @@ void TileMap::Update()
 	m_colorMap->Update();
 }
 
-bool TileMap::TakeFood(const IntVec2 &pos)
+int TileMap::ClaimFood(const IntVec2 &pos)
 {
 	if ( !m_boundsChecker.IsInBounds(pos))
 	{
-		return false;
+		return -1;
 	}
 
-	bool depleted = m_tiles[pos.y][pos.x]->Take();
-	if ( depleted )
+	const int amountLeft = m_tiles[pos.y][pos.x]->Claim();
+	// Exactly one claim sees the last unit taken
+	if ( amountLeft == 0 )
 	{
-		SetTile(pos, TileType::eEmpty);
+		m_depletedTiles.Local().push_back(pos);
 	}
-	return depleted;
+	return amountLeft;
+}
+
+void TileMap::ApplyDepletions()
+{
+	for ( size_t thread = 0; thread < m_depletedTiles.Size(); ++thread )
+	{
+		auto &depletedTiles = m_depletedTiles[thread];
+		for ( const auto &pos: depletedTiles )
+		{
+			SetTile(pos, TileType::eEmpty);
+		}
+		depletedTiles.clear();
+	}
+	m_depletedTiles.Resize();
 }
 
 void TileMap::Clear()
@@ -105,11 +124,6 @@ void TileMap::Clear()
 	}
 }
 
-void TileMap::Draw() const
-{
-	m_colorMap->Draw();
-}
-
 void TileMap::UpdateColorMap(const IntVec2 &pos)
 {
 	m_colorMap->Set(pos, m_tiles[pos.y][pos.x]->GetColor());
@@ -6,6 +6,7 @@
 
 #include "BoundsChecker.hpp"
 #include "IntVec.hpp"
+#include "PerThread.hpp"
 
 #include "Tile.hpp"
 #include "ColorMap.hpp"
@@ -14,6 +15,9 @@ class Nest;
 
 class TileMap
 {
+	// Saves and restores state which isn't exposed otherwise
+	friend class Checkpoint;
+
 public:
 	TileMap(int width, int height);
 
@@ -24,14 +28,19 @@ public:
 
 	void PlaceNest(Nest &nest);
 
-	bool TakeFood(const IntVec2 &pos);
+	// Takes a unit of food from the tile, may be called in parallel, see Tile::Claim.
+	// Emptied tiles stay food tiles until ApplyDepletions is called
+	int ClaimFood(const IntVec2 &pos);
+	int GetFoodAmount(const IntVec2 &pos) const { return GetTile(pos).GetAmount(); }
+	// Turns tiles emptied since the last call into empty tiles, has to be called serially
+	void ApplyDepletions();
 
 	void Clear();
 
 	inline const Tile &GetTile(const IntVec2 &pos) const;
 	inline TileType GetTileType(const IntVec2 &pos) const { return GetTile(pos).GetType(); }
 
-	void Draw() const;
+	ColorMap &GetColorMap() { return *m_colorMap; }
 
 	int GetWidth() const { return m_width; }
 	int GetHeight() const { return m_height; }
@@ -48,6 +57,8 @@ private:
 
 	BoundsChecker2D m_boundsChecker;
 
+	PerThread<std::vector<IntVec2>> m_depletedTiles;
+
 	Tile m_errorTile{TileType::eWall};
 
 	Nest *m_nest = nullptr;
@@ -0,0 +1,111 @@
+#include "Tracer.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+Tracer &Tracer::Instance()
+{
+	static Tracer tracer;
+	return tracer;
+}
+
+void Tracer::Start()
+{
+	{
+		std::lock_guard lock(m_threadsMutex);
+		for ( auto &thread: m_threads )
+		{
+			thread->startedAt.store(thread->written.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+	}
+	m_enabled.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::Stop()
+{
+	m_enabled.store(false, std::memory_order_relaxed);
+}
+
+void Tracer::Record(const char *name, int64_t start, int64_t end, int64_t arg)
+{
+	ThreadEvents   &thread  = GetThreadEvents();
+	const uint64_t written = thread.written.load(std::memory_order_relaxed);
+
+	thread.events[written % k_eventsPerThread] = {name, start, end, arg};
+	thread.written.store(written + 1, std::memory_order_release);
+}
+
+int64_t Tracer::GetTime() const
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+}
+
+Tracer::ThreadEvents &Tracer::GetThreadEvents()
+{
+	// Tracer is a singleton, so a thread needs only one pointer
+	thread_local ThreadEvents *threadEvents = nullptr;
+	if ( threadEvents == nullptr )
+	{
+		std::lock_guard lock(m_threadsMutex);
+		m_threads.push_back(std::make_unique<ThreadEvents>());
+		threadEvents = m_threads.back().get();
+		threadEvents->threadId = static_cast<uint32_t>(m_threads.size());
+	}
+
+	return *threadEvents;
+}
+
+bool Tracer::Write(const std::string &filename) const
+{
+	FILE *file = std::fopen(filename.c_str(), "w");
+	if ( file == nullptr )
+	{
+		return false;
+	}
+
+	std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	std::vector<Event> events;
+	bool               first = true;
+
+	std::lock_guard lock(m_threadsMutex);
+	for ( const auto &thread: m_threads )
+	{
+		const uint64_t written   = thread->written.load(std::memory_order_acquire);
+		const uint64_t startedAt = thread->startedAt.load(std::memory_order_relaxed);
+		const uint64_t begin     = std::max(startedAt, written > k_eventsPerThread ? written - k_eventsPerThread : 0);
+
+		events.assign(written - begin, {});
+		for ( uint64_t i = begin; i < written; ++i )
+		{
+			events[i - begin] = thread->events[i % k_eventsPerThread];
+		}
+
+		// Thread may have overwritten the oldest of the copied events meanwhile
+		const uint64_t writtenAfter = thread->written.load(std::memory_order_acquire);
+		if ( writtenAfter >= k_eventsPerThread && writtenAfter - k_eventsPerThread + 1 > begin )
+		{
+			const uint64_t overwritten = std::min(writtenAfter - k_eventsPerThread + 1, written) - begin;
+			events.erase(events.begin(), events.begin() + static_cast<std::ptrdiff_t>(overwritten));
+		}
+
+		std::fprintf(file, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"Thread %u\"}}",
+		             first ? "" : ",\n", thread->threadId, thread->threadId);
+		first = false;
+
+		for ( const Event &event: events )
+		{
+			std::fprintf(file, ",\n{\"ph\":\"X\",\"name\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+			             event.name, thread->threadId, static_cast<double>(event.start) / 1000.0,
+			             static_cast<double>(event.end - event.start) / 1000.0);
+			if ( event.arg >= 0 )
+			{
+				std::fprintf(file, ",\"args\":{\"value\":%lld}", static_cast<long long>(event.arg));
+			}
+			std::fprintf(file, "}");
+		}
+	}
+
+	std::fprintf(file, "\n]}\n");
+	return std::fclose(file) == 0;
+}
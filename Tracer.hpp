@@ -0,0 +1,100 @@
+#ifndef ANTS_TRACER_HPP
+#define ANTS_TRACER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* Opt-in timeline of what every thread, OpenMP workers included, does during ticks and frames.
+ * Events are written as Chrome trace-event JSON, which opens in Perfetto or chrome://tracing.
+ *
+ * Every thread records into its own ring buffer, which only it writes to, so recording takes no locks:
+ * the event is stored and then the write counter is published. Ring keeps the last k_eventsPerThread events.
+ * Write reads the rings while threads may still record, events which could have been overwritten
+ * meanwhile are dropped. Names have to be string literals, only pointers to them are stored */
+class Tracer
+{
+public:
+	static constexpr size_t k_eventsPerThread = 1 << 16;
+
+	static Tracer &Instance();
+
+	// Drops recorded events and starts recording
+	void Start();
+	void Stop();
+	bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+	// Starts are taken by GetTime, arg is shown with the event unless it's negative
+	void Record(const char *name, int64_t start, int64_t end, int64_t arg);
+	// Nanoseconds since the tracer was created
+	int64_t GetTime() const;
+
+	bool Write(const std::string &filename) const;
+
+private:
+	struct Event
+	{
+		const char *name;
+		int64_t    start;
+		int64_t    end;
+		int64_t    arg;
+	};
+
+	struct ThreadEvents
+	{
+		uint32_t                 threadId;
+		std::unique_ptr<Event[]> events = std::make_unique<Event[]>(k_eventsPerThread);
+		// Events ever recorded, event i is at i % k_eventsPerThread
+		std::atomic<uint64_t>    written{0};
+		// Events recorded before this one are dropped by Start
+		std::atomic<uint64_t>    startedAt{0};
+	};
+
+	ThreadEvents &GetThreadEvents();
+
+private:
+	const std::chrono::steady_clock::time_point m_epoch = std::chrono::steady_clock::now();
+
+	std::atomic<bool> m_enabled{false};
+
+	mutable std::mutex                         m_threadsMutex;
+	std::vector<std::unique_ptr<ThreadEvents>> m_threads;
+};
+
+// Records time from construction to destruction as an event of the calling thread
+class TraceScope
+{
+public:
+	explicit TraceScope(const char *name, int64_t arg = -1) :
+			m_name(name), m_arg(arg), m_enabled(Tracer::Instance().IsEnabled())
+	{
+		if ( m_enabled )
+		{
+			m_start = Tracer::Instance().GetTime();
+		}
+	}
+
+	~TraceScope()
+	{
+		if ( m_enabled )
+		{
+			Tracer &tracer = Tracer::Instance();
+			tracer.Record(m_name, m_start, tracer.GetTime(), m_arg);
+		}
+	}
+
+	TraceScope(const TraceScope &) = delete;
+	TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+	const char *m_name;
+	int64_t    m_arg;
+	bool       m_enabled;
+	int64_t    m_start = 0;
+};
+
+#endif //ANTS_TRACER_HPP
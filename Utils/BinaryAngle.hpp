@@ -0,0 +1,63 @@
+#ifndef ANTS_BINARYANGLE_HPP
+#define ANTS_BINARYANGLE_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <array>
+
+// Full turn is 2^16, so angles wrap around for free and never lose precision
+using Angle = uint16_t;
+
+class BinaryAngle
+{
+public:
+	static constexpr Angle k_halfTurn    = 0x8000;
+	static constexpr Angle k_quarterTurn = 0x4000;
+	static constexpr Angle k_eighthTurn  = 0x2000;
+
+	static constexpr float k_radiansToAngle = static_cast<float>(65536.0 / ( 2.0 * M_PI ));
+	static constexpr float k_angleToRadians = static_cast<float>(2.0 * M_PI / 65536.0);
+
+	// Sine is tabulated for 2^12 angles, cosine reads the same table a quarter turn ahead
+	static constexpr int k_tableBits        = 12;
+	static constexpr int k_tableSize        = 1 << k_tableBits;
+	static constexpr int k_tableShift       = 16 - k_tableBits;
+	static constexpr int k_cosineTableShift = k_tableSize / 4;
+
+	static Angle FromRadians(float radians)
+	{
+		return static_cast<Angle>(static_cast<uint32_t>(std::lrint(radians * k_radiansToAngle)));
+	}
+
+	static float ToRadians(Angle angle) { return static_cast<float>(angle) * k_angleToRadians; }
+	static float ToDegrees(Angle angle) { return static_cast<float>(angle) * ( 360.f / 65536.f ); }
+
+	// Signed shortest turn from 'from' to 'to', in [-2^15, 2^15)
+	static int Difference(Angle to, Angle from) { return static_cast<int16_t>(static_cast<Angle>(to - from)); }
+
+	static int TableIndex(Angle angle)
+	{
+		return (( angle + ( 1 << ( k_tableShift - 1 ))) >> k_tableShift ) & ( k_tableSize - 1 );
+	}
+
+	static float Sin(Angle angle) { return s_sinTable[TableIndex(angle)]; }
+	static float Cos(Angle angle) { return s_sinTable[TableIndex(angle) + k_cosineTableShift]; }
+
+	// For vectorized lookups, sine of table index i is at [i], cosine at [i + k_cosineTableShift]
+	static const float *GetSinTable() { return s_sinTable.data(); }
+
+private:
+	static std::array<float, k_tableSize + k_cosineTableShift> BuildSinTable()
+	{
+		std::array<float, k_tableSize + k_cosineTableShift> table{};
+		for ( size_t i = 0; i < table.size(); ++i )
+		{
+			table[i] = static_cast<float>(std::sin(2.0 * M_PI * static_cast<double>(i) / k_tableSize));
+		}
+		return table;
+	}
+
+	inline static const std::array<float, k_tableSize + k_cosineTableShift> s_sinTable = BuildSinTable();
+};
+
+#endif //ANTS_BINARYANGLE_HPP
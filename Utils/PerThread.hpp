@@ -0,0 +1,40 @@
+#ifndef ANTS_PERTHREAD_HPP
+#define ANTS_PERTHREAD_HPP
+
+#include <cstddef>
+#include <vector>
+#include <omp.h>
+
+// One value for every OpenMP thread, each on its own cache line to avoid false sharing.
+// Local() may be called from parallel regions, everything else has to be called serially.
+template<typename T>
+class PerThread
+{
+	struct alignas(64) Slot
+	{
+		T value;
+	};
+
+public:
+	PerThread() { Resize(); }
+
+	inline T &Local() { return m_slots[omp_get_thread_num()].value; }
+
+	// Makes sure there is a value for every thread of the next parallel region
+	void Resize()
+	{
+		const auto threadsAmount = static_cast<size_t>(omp_get_max_threads());
+		if ( m_slots.size() < threadsAmount )
+		{
+			m_slots.resize(threadsAmount);
+		}
+	}
+
+	size_t Size() const { return m_slots.size(); }
+	T &operator[](size_t thread) { return m_slots[thread].value; }
+
+private:
+	std::vector<Slot> m_slots;
+};
+
+#endif //ANTS_PERTHREAD_HPP
@@ -2,10 +2,15 @@
 #define ANTS_RANDOM_HPP
 
 #include <random>
+#include <cstdint>
 
 class Random
 {
 public:
+	// Every thread has its own generator, seeded randomly. Seeding it makes world generation
+	// and nest placement on the calling thread repeatable
+	static void Seed(uint32_t seed) { m_generator.seed(seed); }
+
 	static float Float(float min, float max)
 	{
 		std::uniform_real_distribution<float> dist(min, max);
@@ -24,8 +29,57 @@ public:
 		return dist(m_generator);
 	}
 
+	/* Stateless counter-based generator, every value is a hash of (seed, tick, stream, id),
+	 * so it can be called from any thread in any order and gives the same results.
+	 * Only 32-bit integer operations are used, so it's easily vectorized (see AntsMovement). */
+
+	// 32-bit integer finalizer by Chris Wellons (lowbias32)
+	static constexpr uint32_t Mix(uint32_t x)
+	{
+		x ^= x >> 16;
+		x *= 0x7feb352dU;
+		x ^= x >> 15;
+		x *= 0x846ca68bU;
+		x ^= x >> 16;
+		return x;
+	}
+
+	// Part of the counter shared by all ids, may be computed once per tick
+	static constexpr uint32_t CounterKey(uint32_t seed, uint32_t tick, uint32_t stream)
+	{
+		return Mix(Mix(seed + 0x9e3779b9U * stream) ^ tick);
+	}
+
+	static constexpr uint32_t Counter(uint32_t key, uint32_t id)
+	{
+		return Mix(key ^ id);
+	}
+
+	// Uses upper 24 bits, so the result is exactly representable and [0, 1) range is kept
+	static constexpr float CounterToFloat(uint32_t value, float min, float max)
+	{
+		return min + ( max - min ) * ( static_cast<float>(value >> 8) * ( 1.f / 16777216.f ));
+	}
+
+	static constexpr int CounterToInt(uint32_t value, int min, int max)
+	{
+		const auto range = static_cast<uint64_t>(static_cast<int64_t>(max) - min + 1);
+		return min + static_cast<int>(( value * range ) >> 32);
+	}
+
+	static constexpr float CounterFloat(float min, float max, uint32_t seed, uint32_t tick, uint32_t stream,
+	                                    uint32_t id)
+	{
+		return CounterToFloat(Counter(CounterKey(seed, tick, stream), id), min, max);
+	}
+
+	static constexpr int CounterInt(int min, int max, uint32_t seed, uint32_t tick, uint32_t stream, uint32_t id)
+	{
+		return CounterToInt(Counter(CounterKey(seed, tick, stream), id), min, max);
+	}
+
 private:
-	inline static std::mt19937 m_generator{std::random_device()()};
+	inline static thread_local std::mt19937 m_generator{std::random_device()()};
 };
 
 #endif //ANTS_RANDOM_HPP
@@ -1,8 +1,6 @@
 #ifndef MICROLUTION_TIMER_HPP
 #define MICROLUTION_TIMER_HPP
 
-#include "raylib.h"
-
 class Timer
 {
 public:
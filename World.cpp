@@ -7,7 +7,7 @@
 #include "omp.h"
 #include <iostream>
 
-World::World()
+World::World(bool generateMap)
 {
 	auto &globalSettings = Settings::Instance().GetGlobalSettings();
 
@@ -21,7 +21,10 @@ World::World()
 
 	m_tileMap = std::make_unique<TileMap>(globalSettings.mapWidth, globalSettings.mapHeight);
 
-	GenerateMap();
+	if ( generateMap )
+	{
+		GenerateMap();
+	}
 }
 
 void World::Update()
@@ -34,16 +37,6 @@ void World::ClearMap()
 	m_tileMap->Clear();
 }
 
-void World::Draw() const
-{
-//	DrawRectangle(-5 * m_screenToWorld, -5 * m_screenToWorld, (m_worldWidth + 10) * m_screenToWorld, (m_worldHeight + 10) * m_screenToWorld, RED);
-//	DrawRectangle(0, 0, m_worldWidth * m_screenToWorld, m_worldHeight * m_screenToWorld, BLACK);
-	DrawRectangle(-5, -5, ( m_worldWidth + 10 ), ( m_worldHeight + 10 ), RED);
-	DrawRectangle(0, 0, m_worldWidth, m_worldHeight, BLACK);
-
-	m_tileMap->Draw();
-}
-
 void World::Erase()
 {
 	m_tileMap->Clear();
@@ -63,39 +56,32 @@ bool CheckColor(Color checked, Color sample)
 	return checked.r == sample.r && checked.g == sample.g && checked.b == sample.b;
 }
 
-bool World::LoadWorldFromImage(Settings &settings, const std::string &imageName)
+bool World::LoadWorldFromColors(Settings &settings, const Color *colors, int width, int height)
 {
-	Image image = LoadImage(imageName.c_str());
-	if ( image.data == nullptr )
-	{
-		std::cout << "Image is null" << std::endl;
-		return false;
-	}
-	Color *colors = LoadImageColors(image);
 	if ( colors == nullptr )
 	{
 		std::cout << "Colors is null" << std::endl;
 		return false;
 	}
 
-	settings.GetGlobalSettings().mapWidth  = image.width;
-	settings.GetGlobalSettings().mapHeight = image.height;
-	m_worldWidth  = image.width;
-	m_worldHeight = image.height;
+	settings.GetGlobalSettings().mapWidth  = width;
+	settings.GetGlobalSettings().mapHeight = height;
+	m_worldWidth  = width;
+	m_worldHeight = height;
 
-	m_tileMap       = std::make_unique<TileMap>(image.width, image.height);
-	m_boundsChecker = std::make_unique<BoundsChecker2D>(0, image.width, 0, image.height);
+	m_tileMap       = std::make_unique<TileMap>(width, height);
+	m_boundsChecker = std::make_unique<BoundsChecker2D>(0, width, 0, height);
 
 	std::cout << "Updating tileMap";
-	for ( int y = 0; y < image.height; ++y )
+	for ( int y = 0; y < height; ++y )
 	{
-		for ( int x = 0; x < image.width; ++x )
+		for ( int x = 0; x < width; ++x )
 		{
-			if ( CheckColor(colors[y * image.width + x], {0, 255, 0, 255}))
+			if ( CheckColor(colors[y * width + x], {0, 255, 0, 255}))
 			{
 				m_tileMap->UnsafeSetTile(x, y, TileType::eFood);
 			}
-			else if ( CheckColor(colors[y * image.width + x], {255, 255, 255, 255}))
+			else if ( CheckColor(colors[y * width + x], {255, 255, 255, 255}))
 			{
 				m_tileMap->UnsafeSetTile(x, y, TileType::eWall);
 			}
@@ -109,7 +95,5 @@ bool World::LoadWorldFromImage(Settings &settings, const std::string &imageName)
 	std::cout << std::endl;
 	std::cout << "Success" << std::endl;
 
-	UnloadImage(image);
-	UnloadImageColors(colors);
 	return true;
 }
\ No newline at end of file
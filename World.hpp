@@ -2,7 +2,6 @@
 #define ANTS_WORLD_HPP
 
 #include <raylib.h>
-#include <rlgl.h>
 
 #include <memory>
 
@@ -14,17 +13,20 @@
 class World
 {
 public:
-	World();
+	// Map is left empty unless it's generated, for worlds which are loaded right after
+	explicit World(bool generateMap = true);
 
 	void Update();
 
-	void Draw() const;
-
 	void ClearMap();
 	void Erase();
 
 	void GenerateMap();
-	bool LoadWorldFromImage(class Settings &settings, const std::string &imageName);
+	// Green pixels are food, white ones are walls, decoding of image files is left to the caller
+	bool LoadWorldFromColors(class Settings &settings, const Color *colors, int width, int height);
+
+	int GetWidth() const { return m_worldWidth; }
+	int GetHeight() const { return m_worldHeight; }
 
 	inline const BoundsChecker2D &BoundsChecker() const { return *m_boundsChecker; }
 	inline TileMap &GetTileMap() { return *m_tileMap; };
@@ -3,7 +3,6 @@
 #include <iostream>
 #include <FastNoiseLite.h>
 
-#include <rlImGui.h>
 #include <raylib.h>
 #include <raymath.h>
 